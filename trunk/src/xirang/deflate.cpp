@@ -49,7 +49,7 @@ namespace xirang{ namespace zip{
 
 		static void zip_free(void* h, void* p){
 			heap* hp = (heap*)h;
-			hp->free(p, -1, 0);
+			hp->free(p, 0, 0);	// size is unknown
 		}
 		int get_winbits(zip_format format, int winbits){
 			switch (format){
@@ -436,5 +436,22 @@ namespace xirang{ namespace zip{
 		return zip_result{ze_ok, src.size(), writer.size()};
 	}
 
+	zip_result inflate_pipelined(io::reader& src, io::writer& dest, zip_format format, dict_type dict,heap* h ){
+		inflate_reader reader(src, format, long_size_t(-1), dict, h);
+		iref<io::reader> from(reader);
+		// overlap decompression with writing
+		auto size = io::copy_data_pipelined(from.get<io::reader>(), dest);
+		return zip_result{ze_ok, reader.compressed_size(), size};
+	}
+	zip_result deflate_pipelined(io::reader& src, io::writer& dest, zip_format format, int level, dict_type dict, heap* h, int strategy_){
+		deflate_writer writer(dest, format, level, dict, h, strategy_);
+		iref<io::writer> to(writer);
+
+		// overlap reading with compression
+		io::copy_data_pipelined(src, to.get<io::writer>());
+		writer.finish();
+		return zip_result{ze_ok, writer.uncompressed_size(), writer.size()};
+	}
+
 }}
 
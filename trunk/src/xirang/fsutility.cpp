@@ -247,10 +247,8 @@ namespace xirang {namespace fs{
     {
 		io::file_reader src(from);
 		io::file_writer dest(to, io::of_create_or_open);
-		iref<io::reader> rd(src);
-		iref<io::writer> wr(dest);
 
-		long_size_t n = io::copy_data(rd.get<io::reader>(), wr.get<io::writer>());
+		long_size_t n = io::copy_data(src, dest);
 		if (n != src.size())
 			AIO_THROW(file_copy_error);
     }
@@ -0,0 +1,208 @@
+#include <xirang/heap.h>
+
+// STD
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+
+namespace xirang
+{
+	namespace
+	{
+		const std::size_t K_max_chunk_size = 1024 * 1024;
+		const std::size_t K_min_alignment = 2 * sizeof(void*);
+
+		char* align_up_(char* p, std::size_t alignment){
+			return reinterpret_cast<char*>((reinterpret_cast<std::uintptr_t>(p) + alignment - 1) & ~std::uintptr_t(alignment - 1));
+		}
+	}
+
+	struct arena_heap_imp
+	{
+		struct chunk
+		{
+			chunk* next;
+			std::size_t size;
+		};
+
+		/// header of oversized blocks, just before the block
+		struct large_block
+		{
+			large_block* prev;
+			large_block* next;
+			void* raw;
+			std::size_t size;
+		};
+
+		arena_heap_imp(heap* under_, memory::thread_policy thp, std::size_t chunk_size_)
+			: under(under_), multi(thp == memory::multi_thread)
+			, chunk_size(chunk_size_), next_chunk_size(chunk_size_), large_threshold(chunk_size_ / 4)
+			, chunks(0), next(0), end(0), reserved(0)
+		{
+			large.prev = large.next = &large;
+		}
+
+		~arena_heap_imp(){
+			release_large();
+			release_chunks(0);
+		}
+
+		void* malloc_large(std::size_t size, std::size_t alignment){
+			std::size_t total = sizeof(large_block) + size + alignment;
+			void* raw = under->malloc(total, K_min_alignment, 0);
+			char* p = align_up_(static_cast<char*>(raw) + sizeof(large_block), alignment);
+			large_block* header = reinterpret_cast<large_block*>(p - sizeof(large_block));
+			header->raw = raw;
+			header->size = total;
+			header->prev = &large;
+			header->next = large.next;
+			large.next->prev = header;
+			large.next = header;
+			reserved += total;
+			return p;
+		}
+
+		void free_large(void* p){
+			large_block* header = reinterpret_cast<large_block*>(static_cast<char*>(p) - sizeof(large_block));
+			header->prev->next = header->next;
+			header->next->prev = header->prev;
+			reserved -= header->size;
+			under->free(header->raw, header->size, K_min_alignment);
+		}
+
+		void* malloc_small(std::size_t size, std::size_t alignment){
+			char* p = align_up_(next, alignment);
+			if (next == 0 || p > end || std::size_t(end - p) < size){
+				new_chunk(size + alignment);
+				p = align_up_(next, alignment);
+			}
+			next = p + size;
+			return p;
+		}
+
+		void new_chunk(std::size_t min_size){
+			std::size_t size = std::max(next_chunk_size, sizeof(chunk) + min_size);
+			chunk* c = static_cast<chunk*>(under->malloc(size, K_min_alignment, 0));
+			c->next = chunks;
+			c->size = size;
+			chunks = c;
+			reserved += size;
+
+			next = reinterpret_cast<char*>(c + 1);
+			end = reinterpret_cast<char*>(c) + size;
+			next_chunk_size = std::min(next_chunk_size * 2, std::max(chunk_size, K_max_chunk_size));
+		}
+
+		void release_large(){
+			while (large.next != &large)
+				free_large(reinterpret_cast<char*>(large.next) + sizeof(large_block));
+		}
+
+		/// release all chunks, but keep the given one for reuse if it is not null
+		void release_chunks(chunk* keep){
+			while (chunks){
+				chunk* c = chunks;
+				chunks = c->next;
+				if (c != keep){
+					reserved -= c->size;
+					under->free(c, c->size, K_min_alignment);
+				}
+			}
+			if (keep){
+				keep->next = 0;
+				chunks = keep;
+				next = reinterpret_cast<char*>(keep + 1);
+				end = reinterpret_cast<char*>(keep) + keep->size;
+			}
+			else {
+				next = end = 0;
+				next_chunk_size = chunk_size;
+			}
+		}
+
+		heap* under;
+		bool multi;
+		std::mutex mutex;
+
+		std::size_t chunk_size;
+		std::size_t next_chunk_size;
+		std::size_t large_threshold;
+
+		chunk* chunks;		///< the newest first
+		char* next;			///< free part of the newest chunk
+		char* end;
+		large_block large;	///< list of oversized blocks
+		std::size_t reserved;
+	};
+
+	arena_heap::arena_heap(heap* under, memory::thread_policy thp, std::size_t chunk_size /* = 64 * 1024 */)
+		: m_imp(0)
+	{
+		AIO_PRE_CONDITION(under != 0 && chunk_size >= 64);
+		m_imp = new arena_heap_imp(under, thp, chunk_size);
+	}
+
+	arena_heap::~arena_heap()
+	{
+		check_delete(m_imp);
+	}
+
+	void* arena_heap::malloc(std::size_t size, std::size_t alignment, const void* /* hint */)
+	{
+		std::unique_lock<std::mutex> lock(m_imp->mutex, std::defer_lock);
+		if (m_imp->multi)
+			lock.lock();
+
+		alignment = std::max(alignment, std::size_t(1));
+		if (size > m_imp->large_threshold)
+			return m_imp->malloc_large(size, std::max(alignment, K_min_alignment));
+		return m_imp->malloc_small(std::max(size, std::size_t(1)), alignment);
+	}
+
+	void arena_heap::free(void* p, std::size_t size, std::size_t /* alignment */)
+	{
+		if (p == 0 || size <= m_imp->large_threshold)
+			return;
+
+		std::unique_lock<std::mutex> lock(m_imp->mutex, std::defer_lock);
+		if (m_imp->multi)
+			lock.lock();
+		m_imp->free_large(p);
+	}
+
+	heap* arena_heap::underling()
+	{
+		return m_imp->under;
+	}
+
+	bool arena_heap::equal_to(const heap& rhs) const
+	{
+		return this == &rhs;
+	}
+
+	void arena_heap::reset()
+	{
+		std::unique_lock<std::mutex> lock(m_imp->mutex, std::defer_lock);
+		if (m_imp->multi)
+			lock.lock();
+		m_imp->release_large();
+		m_imp->release_chunks(m_imp->chunks);
+	}
+
+	void arena_heap::release_all()
+	{
+		std::unique_lock<std::mutex> lock(m_imp->mutex, std::defer_lock);
+		if (m_imp->multi)
+			lock.lock();
+		m_imp->release_large();
+		m_imp->release_chunks(0);
+	}
+
+	std::size_t arena_heap::reserved_size() const
+	{
+		std::unique_lock<std::mutex> lock(m_imp->mutex, std::defer_lock);
+		if (m_imp->multi)
+			lock.lock();
+		return m_imp->reserved;
+	}
+}
@@ -0,0 +1,405 @@
+#include <xirang/heap.h>
+
+// STD
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace xirang
+{
+	namespace
+	{
+		/// slabs are aligned to their size, so the header of a block is found by masking its address
+		const std::size_t K_slab_size = 64 * 1024;
+		/// slabs are carved from segments allocated from the underling heap
+		const std::size_t K_segment_size = 16 * K_slab_size;
+		/// larger blocks are forwarded to the underling heap
+		const std::size_t K_max_small = 4096;
+		const std::size_t K_granule = 16;
+		/// max cached bytes of each size class in a thread
+		const std::size_t K_thread_cache_bytes = 16 * 1024;
+		/// count of pools cached by a thread at the same time
+		const std::size_t K_thread_cache_pools = 4;
+
+		/// 16 bytes step up to 128, then 4 classes per power of 2
+		const std::size_t K_class_size[] = {
+			16, 32, 48, 64, 80, 96, 112, 128,
+			160, 192, 224, 256, 320, 384, 448, 512,
+			640, 768, 896, 1024, 1280, 1536, 1792, 2048,
+			2560, 3072, 3584, 4096
+		};
+		const std::size_t K_class_count = sizeof(K_class_size) / sizeof(K_class_size[0]);
+
+		struct free_block_
+		{
+			free_block_* next;
+		};
+
+		struct slab_header_
+		{
+			pool_heap_imp* owner;
+			std::size_t class_index;
+		};
+
+		std::size_t lowbit_(std::size_t v){
+			return v & (~v + 1);
+		}
+
+		/// blocks are aligned to the lowest bit of their size
+		std::size_t first_offset_(std::size_t class_index){
+			std::size_t align = lowbit_(K_class_size[class_index]);
+			return (sizeof(slab_header_) + align - 1) / align * align;
+		}
+
+		/// \pre 0 < size <= K_max_small
+		std::size_t class_of_(std::size_t size){
+			if (size <= 128)
+				return (size + K_granule - 1) / K_granule - 1;
+			unsigned log = 7;	// size in (2^log, 2^(log + 1)]
+			while ((size - 1) >> (log + 1))
+				++log;
+			return 8 + (log - 7) * 4 + ((size - 1) >> (log - 2)) - 4;
+		}
+
+		/// \return K_class_count for large blocks
+		std::size_t class_for_(std::size_t size, std::size_t alignment){
+			if (size > K_max_small || alignment > K_max_small)
+				return K_class_count;
+			if (size == 0)
+				size = 1;
+			if (alignment > K_granule)
+				size = (size + alignment - 1) / alignment * alignment;
+			std::size_t c = class_of_(size);
+			while (lowbit_(K_class_size[c]) < alignment)
+				++c;
+			return c;
+		}
+
+		/// max cached blocks of a size class in a thread
+		std::size_t cache_limit_(std::size_t class_index){
+			return std::max<std::size_t>(4, K_thread_cache_bytes / K_class_size[class_index]);
+		}
+
+		std::atomic<uint64_t> g_next_pool_id(1);
+
+		/// ids of the pools which accept blocks cached by threads
+		std::mutex& live_pools_mutex_(){
+			static std::mutex mutex;
+			return mutex;
+		}
+		std::set<uint64_t>& live_pools_(){
+			static std::set<uint64_t> pools;
+			return pools;
+		}
+	}
+
+	struct pool_heap_imp
+	{
+		struct size_class
+		{
+			size_class() : free_list(0), next(0), end(0){}
+
+			std::mutex mutex;
+			free_block_* free_list;
+			char* next;		///< unused part of the last slab
+			char* end;
+		};
+
+		pool_heap_imp(heap* under_, memory::thread_policy thp)
+			: under(under_), multi(thp == memory::multi_thread), cached(multi)
+			, id(g_next_pool_id++), slab_next(0), slab_end(0)
+		{
+			if (multi){
+				std::lock_guard<std::mutex> lock(live_pools_mutex_());
+				live_pools_().insert(id);
+			}
+		}
+
+		~pool_heap_imp(){
+			for (auto& i : segments)
+				under->free(i.second, K_segment_size + K_slab_size, K_slab_size);
+		}
+
+		/// take at most n blocks from the shared lists, at least one
+		/// \return count of blocks linked from head
+		std::size_t fetch(std::size_t c, free_block_*& head, std::size_t n){
+			auto& sc = classes[c];
+			std::unique_lock<std::mutex> lock(sc.mutex, std::defer_lock);
+			if (multi)
+				lock.lock();
+
+			std::size_t count = 0;
+			head = 0;
+			free_block_** tail = &head;
+			for (; count < n && sc.free_list; ++count){
+				*tail = sc.free_list;
+				tail = &sc.free_list->next;
+				sc.free_list = sc.free_list->next;
+			}
+
+			std::size_t size = K_class_size[c];
+			if (count == 0 && std::size_t(sc.end - sc.next) < size){
+				char* slab = new_slab(c);
+				sc.next = slab + first_offset_(c);
+				sc.end = slab + K_slab_size;
+			}
+			for (; count < n && std::size_t(sc.end - sc.next) >= size; ++count){
+				free_block_* b = reinterpret_cast<free_block_*>(sc.next);
+				sc.next += size;
+				*tail = b;
+				tail = &b->next;
+			}
+			*tail = 0;
+			return count;
+		}
+
+		/// return a list of blocks to the shared list
+		void release(std::size_t c, free_block_* first, free_block_* last){
+			auto& sc = classes[c];
+			std::unique_lock<std::mutex> lock(sc.mutex, std::defer_lock);
+			if (multi)
+				lock.lock();
+			last->next = sc.free_list;
+			sc.free_list = first;
+		}
+
+		char* new_slab(std::size_t c){
+			std::unique_lock<std::mutex> lock(slab_mutex, std::defer_lock);
+			if (multi)
+				lock.lock();
+
+			if (slab_next == slab_end){
+				segments.reserve(segments.size() + 1);
+				void* raw = under->malloc(K_segment_size + K_slab_size, K_slab_size, 0);
+				char* first = reinterpret_cast<char*>((reinterpret_cast<std::uintptr_t>(raw) + K_slab_size - 1) & ~std::uintptr_t(K_slab_size - 1));
+				auto pos = std::upper_bound(segments.begin(), segments.end(), std::make_pair(first, raw));
+				segments.insert(pos, std::make_pair(first, raw));
+				slab_next = first;
+				slab_end = first + K_segment_size;
+			}
+
+			char* slab = slab_next;
+			slab_next += K_slab_size;
+			slab_header_* header = reinterpret_cast<slab_header_*>(slab);
+			header->owner = this;
+			header->class_index = c;
+			return slab;
+		}
+
+		/// slow check of the blocks freed with unknown size
+		bool owns(void* p){
+			std::unique_lock<std::mutex> lock(slab_mutex, std::defer_lock);
+			if (multi)
+				lock.lock();
+			char* cp = static_cast<char*>(p);
+			auto pos = std::upper_bound(segments.begin(), segments.end(), std::make_pair(cp, static_cast<void*>(0)),
+					[](const std::pair<char*, void*>& lhs, const std::pair<char*, void*>& rhs){ return lhs.first < rhs.first; });
+			return pos != segments.begin()
+				&& cp < (pos - 1)->first + K_segment_size;
+		}
+
+		heap* under;
+		bool multi;
+		std::atomic<bool> cached;	///< thread caches are in use
+		uint64_t id;
+
+		size_class classes[K_class_count];
+
+		std::mutex slab_mutex;
+		char* slab_next;
+		char* slab_end;
+		std::vector<std::pair<char*, void*> > segments;	///< aligned first slab and raw block, sorted
+	};
+
+	namespace
+	{
+		/// free blocks cached by current thread, a few pools per thread
+		struct thread_cache_
+		{
+			struct entry
+			{
+				uint64_t id;
+				pool_heap_imp* owner;
+				free_block_* lists[K_class_count];
+				std::size_t counts[K_class_count];
+			};
+
+			thread_cache_() : victim(0){
+				for (auto& i : entries)
+					clear(i);
+			}
+			~thread_cache_();
+
+			entry& get(pool_heap_imp* pool){
+				for (auto& i : entries)
+					if (i.id == pool->id)
+						return i;
+				entry* slot = 0;
+				for (auto& i : entries)
+					if (i.id == 0){
+						slot = &i;
+						break;
+					}
+				if (!slot){
+					slot = &entries[victim++ % K_thread_cache_pools];
+					flush(*slot);
+				}
+				slot->id = pool->id;
+				slot->owner = pool;
+				return *slot;
+			}
+			entry* find(pool_heap_imp* pool){
+				for (auto& i : entries)
+					if (i.id == pool->id)
+						return &i;
+				return 0;
+			}
+
+			/// return the cached blocks if the pool is still alive
+			void flush(entry& e){
+				if (e.id != 0){
+					std::lock_guard<std::mutex> lock(live_pools_mutex_());
+					if (live_pools_().count(e.id) != 0)
+						release_all(e);
+				}
+				clear(e);
+			}
+			static void release_all(entry& e){
+				for (std::size_t c = 0; c < K_class_count; ++c){
+					if (e.lists[c] == 0)
+						continue;
+					free_block_* last = e.lists[c];
+					while (last->next)
+						last = last->next;
+					e.owner->release(c, e.lists[c], last);
+				}
+			}
+			static void clear(entry& e){
+				e.id = 0;
+				e.owner = 0;
+				std::fill(e.lists, e.lists + K_class_count, static_cast<free_block_*>(0));
+				std::fill(e.counts, e.counts + K_class_count, 0);
+			}
+
+			entry entries[K_thread_cache_pools];
+			std::size_t victim;
+		};
+
+		thread_local thread_cache_ t_thread_cache;
+		/// set when t_thread_cache is destroyed, the pools are still used by the dtors of other objects later.
+		/// it's trivial, so it's valid until the thread is gone.
+		thread_local bool t_thread_cache_destroyed = false;
+	}
+
+	thread_cache_::~thread_cache_(){
+		t_thread_cache_destroyed = true;
+		for (auto& i : entries)
+			flush(i);
+	}
+
+	pool_heap::pool_heap(heap* under, memory::thread_policy thp)
+		: m_imp(0)
+	{
+		AIO_PRE_CONDITION(under != 0);
+		m_imp = new pool_heap_imp(under, thp);
+	}
+
+	pool_heap::~pool_heap()
+	{
+		prepare_destroy();
+		check_delete(m_imp);
+	}
+
+	void* pool_heap::malloc(std::size_t size, std::size_t alignment, const void* hint)
+	{
+		std::size_t c = class_for_(size, alignment);
+		if (c == K_class_count)
+			return m_imp->under->malloc(size, alignment, hint);
+
+		free_block_* b = 0;
+		if (m_imp->cached.load(std::memory_order_relaxed) && !t_thread_cache_destroyed){
+			auto& e = t_thread_cache.get(m_imp);
+			if (e.lists[c] == 0)
+				e.counts[c] = m_imp->fetch(c, e.lists[c], cache_limit_(c) / 2);
+			b = e.lists[c];
+			e.lists[c] = b->next;
+			--e.counts[c];
+		}
+		else
+			m_imp->fetch(c, b, 1);
+		return b;
+	}
+
+	void pool_heap::free(void* p, std::size_t size, std::size_t alignment)
+	{
+		if (p == 0)
+			return;
+
+		bool small = size == 0
+			? m_imp->owns(p)
+			: size <= K_max_small && alignment <= K_max_small;
+		if (!small){
+			m_imp->under->free(p, size, alignment);
+			return;
+		}
+
+		slab_header_* header = reinterpret_cast<slab_header_*>(reinterpret_cast<std::uintptr_t>(p) & ~std::uintptr_t(K_slab_size - 1));
+		AIO_PRE_CONDITION(header->owner == m_imp);
+		std::size_t c = header->class_index;
+		free_block_* b = static_cast<free_block_*>(p);
+
+		if (m_imp->cached.load(std::memory_order_relaxed) && !t_thread_cache_destroyed){
+			auto& e = t_thread_cache.get(m_imp);
+			b->next = e.lists[c];
+			e.lists[c] = b;
+			if (++e.counts[c] > cache_limit_(c)){
+				// return the older half
+				std::size_t keep = cache_limit_(c) / 2;
+				free_block_* last = b;
+				for (std::size_t i = 1; i < keep; ++i)
+					last = last->next;
+				free_block_* first = last->next;
+				last->next = 0;
+				e.counts[c] = keep;
+
+				last = first;
+				while (last->next)
+					last = last->next;
+				m_imp->release(c, first, last);
+			}
+		}
+		else{
+			b->next = 0;
+			m_imp->release(c, b, b);
+		}
+	}
+
+	heap* pool_heap::underling()
+	{
+		return m_imp->under;
+	}
+
+	bool pool_heap::equal_to(const heap& rhs) const
+	{
+		return this == &rhs;
+	}
+
+	void pool_heap::prepare_destroy()
+	{
+		if (!m_imp->cached.exchange(false))
+			return;
+		{
+			std::lock_guard<std::mutex> lock(live_pools_mutex_());
+			live_pools_().erase(m_imp->id);
+		}
+		auto e = t_thread_cache_destroyed ? 0 : t_thread_cache.find(m_imp);
+		if (e){
+			thread_cache_::release_all(*e);
+			thread_cache_::clear(*e);
+		}
+	}
+}
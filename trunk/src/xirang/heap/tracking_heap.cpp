@@ -0,0 +1,324 @@
+#include <xirang/heap/tracking_heap.h>
+#include <xirang/to_string.h>
+
+// STD
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#ifdef AIO_HEAP_TRACKING_TAGS
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#endif
+
+namespace xirang
+{
+	namespace
+	{
+		std::size_t bin_of_(std::size_t size){
+			std::size_t bin = 0;
+			while (bin + 1 < K_heap_histogram_bins && (long_size_t(1) << bin) < size)
+				++bin;
+			return bin;
+		}
+
+		void update_peak_(std::atomic<long_size_t>& peak, long_size_t value){
+			long_size_t old = peak.load(std::memory_order_relaxed);
+			while (old < value && !peak.compare_exchange_weak(old, value, std::memory_order_relaxed))
+				;
+		}
+
+		const char* tag_name_(const char* tag){
+			return tag ? tag : "(untagged)";
+		}
+
+		void append_json_string_(to_string& out, const char* s){
+			const char* hex = "0123456789abcdef";
+			out("\"");
+			for (; *s; ++s){
+				unsigned char c = *s;
+				if (c == '"' || c == '\\'){
+					char esc[] = { '\\', char(c), 0 };
+					out(esc);
+				}
+				else if (c < 0x20){
+					char esc[] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf], 0 };
+					out(esc);
+				}
+				else{
+					char ch[] = { char(c), 0 };
+					out(ch);
+				}
+			}
+			out("\"");
+		}
+
+#ifdef AIO_HEAP_TRACKING_TAGS
+		thread_local const char* t_heap_tag = 0;
+
+		/// same tags may have different address in different modules
+		struct tag_less_
+		{
+			bool operator()(const char* lhs, const char* rhs) const{
+				if (lhs == 0 || rhs == 0)
+					return lhs == 0 && rhs != 0;
+				return std::strcmp(lhs, rhs) < 0;
+			}
+		};
+#endif
+	}
+
+	struct tracking_heap_imp
+	{
+		explicit tracking_heap_imp(heap* under_)
+			: under(under_), start(std::chrono::steady_clock::now())
+		{
+			live_bytes = 0;
+			live_blocks = 0;
+			peak_bytes = 0;
+			peak_blocks = 0;
+			total_allocs = 0;
+			total_frees = 0;
+			total_bytes = 0;
+			unsized_frees = 0;
+			for (auto& i : histogram)
+				i = 0;
+		}
+
+		void on_malloc(void* p, std::size_t size){
+			update_peak_(peak_bytes, live_bytes.fetch_add(size, std::memory_order_relaxed) + size);
+			update_peak_(peak_blocks, live_blocks.fetch_add(1, std::memory_order_relaxed) + 1);
+			total_allocs.fetch_add(1, std::memory_order_relaxed);
+			total_bytes.fetch_add(size, std::memory_order_relaxed);
+			histogram[bin_of_(size)].fetch_add(1, std::memory_order_relaxed);
+
+#ifdef AIO_HEAP_TRACKING_TAGS
+			std::lock_guard<std::mutex> lock(mutex);
+			block_info info = { size, t_heap_tag };
+			blocks[p] = info;
+			auto& tag = tags[t_heap_tag];
+			tag.live_bytes += size;
+			++tag.live_blocks;
+			++tag.total_allocs;
+			tag.total_bytes += size;
+#else
+			unuse(p);
+#endif
+		}
+
+		void on_free(void* p, std::size_t size){
+			if (size == 0)
+				unsized_frees.fetch_add(1, std::memory_order_relaxed);
+
+#ifdef AIO_HEAP_TRACKING_TAGS
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				auto pos = blocks.find(p);
+				if (pos != blocks.end()){
+					size = pos->second.size;
+					auto& tag = tags[pos->second.tag];
+					tag.live_bytes -= size;
+					--tag.live_blocks;
+					blocks.erase(pos);
+				}
+			}
+#else
+			unuse(p);
+#endif
+			live_bytes.fetch_sub(size, std::memory_order_relaxed);
+			live_blocks.fetch_sub(1, std::memory_order_relaxed);
+			total_frees.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		heap* under;
+		std::chrono::steady_clock::time_point start;
+
+		std::atomic<long_size_t> live_bytes;
+		std::atomic<long_size_t> live_blocks;
+		std::atomic<long_size_t> peak_bytes;
+		std::atomic<long_size_t> peak_blocks;
+		std::atomic<long_size_t> total_allocs;
+		std::atomic<long_size_t> total_frees;
+		std::atomic<long_size_t> total_bytes;
+		std::atomic<long_size_t> unsized_frees;
+		std::atomic<long_size_t> histogram[K_heap_histogram_bins];
+
+#ifdef AIO_HEAP_TRACKING_TAGS
+		struct block_info
+		{
+			std::size_t size;
+			const char* tag;
+		};
+		struct tag_info
+		{
+			tag_info() : live_bytes(0), live_blocks(0), total_allocs(0), total_bytes(0){}
+			long_size_t live_bytes;
+			long_size_t live_blocks;
+			long_size_t total_allocs;
+			long_size_t total_bytes;
+		};
+
+		/// std containers don't allocate from the xirang heaps, so a global tracking heap doesn't re-enter.
+		std::mutex mutex;
+		std::unordered_map<void*, block_info> blocks;
+		std::map<const char*, tag_info, tag_less_> tags;
+#endif
+	};
+
+	tracking_heap::tracking_heap(heap* under)
+		: m_imp(0)
+	{
+		AIO_PRE_CONDITION(under != 0);
+		m_imp = new tracking_heap_imp(under);
+	}
+
+	tracking_heap::~tracking_heap()
+	{
+		check_delete(m_imp);
+	}
+
+	void* tracking_heap::malloc(std::size_t size, std::size_t alignment, const void* hint)
+	{
+		void* p = m_imp->under->malloc(size, alignment, hint);
+		m_imp->on_malloc(p, size);
+		return p;
+	}
+
+	void tracking_heap::free(void* p, std::size_t size, std::size_t alignment)
+	{
+		if (p == 0)
+			return;
+		// forget the block before it can be reused by other threads
+		m_imp->on_free(p, size);
+		m_imp->under->free(p, size, alignment);
+	}
+
+	heap* tracking_heap::underling()
+	{
+		return m_imp->under;
+	}
+
+	bool tracking_heap::equal_to(const heap& rhs) const
+	{
+		return this == &rhs;
+	}
+
+	heap_statistics tracking_heap::snapshot() const
+	{
+		heap_statistics stat;
+		stat.live_bytes = m_imp->live_bytes;
+		stat.live_blocks = m_imp->live_blocks;
+		stat.peak_bytes = m_imp->peak_bytes;
+		stat.peak_blocks = m_imp->peak_blocks;
+		stat.total_allocs = m_imp->total_allocs;
+		stat.total_frees = m_imp->total_frees;
+		stat.total_bytes = m_imp->total_bytes;
+		stat.unsized_frees = m_imp->unsized_frees;
+		stat.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_imp->start).count();
+		for (std::size_t i = 0; i < K_heap_histogram_bins; ++i)
+			stat.histogram[i] = m_imp->histogram[i];
+
+#ifdef AIO_HEAP_TRACKING_TAGS
+		std::lock_guard<std::mutex> lock(m_imp->mutex);
+		for (auto& i : m_imp->tags){
+			heap_tag_statistics tag = { i.first, i.second.live_bytes, i.second.live_blocks, i.second.total_allocs, i.second.total_bytes };
+			stat.tags.push_back(tag);
+		}
+#endif
+		return stat;
+	}
+
+	void tracking_heap::reset_peak()
+	{
+		m_imp->peak_bytes = m_imp->live_bytes.load();
+		m_imp->peak_blocks = m_imp->live_blocks.load();
+	}
+
+	string format_text(const heap_statistics& stat)
+	{
+		to_string out;
+		out("live: ")(stat.live_bytes)(" bytes in ")(stat.live_blocks)(" blocks\n");
+		out("peak: ")(stat.peak_bytes)(" bytes, ")(stat.peak_blocks)(" blocks\n");
+		out("allocs: ")(stat.total_allocs)(", ")(stat.total_bytes)(" bytes\n");
+		out("frees: ")(stat.total_frees)(", unsized: ")(stat.unsized_frees)("\n");
+		out("rate: ")(stat.alloc_rate())(" allocs/s in ")(stat.seconds)(" s\n");
+		out("sizes:\n");
+		for (std::size_t i = 0; i < K_heap_histogram_bins; ++i){
+			if (stat.histogram[i] == 0)
+				continue;
+			if (i + 1 < K_heap_histogram_bins)
+				out("  <= ")(long_size_t(1) << i)(": ")(stat.histogram[i])("\n");
+			else
+				out("  > ")(long_size_t(1) << (i - 1))(": ")(stat.histogram[i])("\n");
+		}
+		if (!stat.tags.empty()){
+			out("tags:\n");
+			for (auto& i : stat.tags)
+				out("  ")(tag_name_(i.tag))(": ")(i.live_bytes)(" bytes in ")(i.live_blocks)(" blocks, ")
+					(i.total_allocs)(" allocs, ")(i.total_bytes)(" bytes\n");
+		}
+		return out.str.str();
+	}
+
+	string format_json(const heap_statistics& stat)
+	{
+		to_string out;
+		out("{\"live_bytes\":")(stat.live_bytes)
+			(",\"live_blocks\":")(stat.live_blocks)
+			(",\"peak_bytes\":")(stat.peak_bytes)
+			(",\"peak_blocks\":")(stat.peak_blocks)
+			(",\"total_allocs\":")(stat.total_allocs)
+			(",\"total_frees\":")(stat.total_frees)
+			(",\"total_bytes\":")(stat.total_bytes)
+			(",\"unsized_frees\":")(stat.unsized_frees)
+			(",\"seconds\":")(stat.seconds)
+			(",\"alloc_rate\":")(stat.alloc_rate());
+
+		// max_size of the last bin is 0, it means unlimited
+		out(",\"histogram\":[");
+		bool first = true;
+		for (std::size_t i = 0; i < K_heap_histogram_bins; ++i){
+			if (stat.histogram[i] == 0)
+				continue;
+			out(first ? "" : ",")("{\"max_size\":")(i + 1 < K_heap_histogram_bins ? long_size_t(1) << i : 0)
+				(",\"count\":")(stat.histogram[i])("}");
+			first = false;
+		}
+		out("]");
+
+		out(",\"tags\":[");
+		first = true;
+		for (auto& i : stat.tags){
+			out(first ? "{\"tag\":" : ",{\"tag\":");
+			if (i.tag)
+				append_json_string_(out, i.tag);
+			else
+				out("null");
+			out(",\"live_bytes\":")(i.live_bytes)
+				(",\"live_blocks\":")(i.live_blocks)
+				(",\"total_allocs\":")(i.total_allocs)
+				(",\"total_bytes\":")(i.total_bytes)("}");
+			first = false;
+		}
+		out("]}");
+		return out.str.str();
+	}
+
+#ifdef AIO_HEAP_TRACKING_TAGS
+	heap_tag_scope::heap_tag_scope(const char* tag)
+		: m_saved(t_heap_tag)
+	{
+		t_heap_tag = tag;
+	}
+
+	heap_tag_scope::~heap_tag_scope()
+	{
+		t_heap_tag = m_saved;
+	}
+
+	const char* heap_tag_scope::current()
+	{
+		return t_heap_tag;
+	}
+#endif
+}
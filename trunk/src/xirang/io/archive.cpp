@@ -1,17 +1,70 @@
 #include <xirang/io.h>
+
+// STD
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <errno.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <linux/fs.h>
+#endif
+
 namespace xirang{ namespace io{
 
-	const long_size_t K_ViewSize = 64 * 1024;
+	/// allocation granularity of mapped views, page size is 4KB or 64KB, and windows requires 64KB.
+	const long_size_t K_ViewGranularity = 64 * 1024;
+
+	namespace {
+		/// view size of copy_data, grows from initial_size to max_size by doubling
+		struct view_sizer
+		{
+			explicit view_sizer(const view_options& opts)
+				: m_size(align_(opts.initial_size)), m_max(std::max(m_size, align_(opts.max_size))){}
+
+			long_size_t next(){
+				auto ret = m_size;
+				m_size = std::min(m_size * 2, m_max);
+				return ret;
+			}
+			private:
+			static long_size_t align_(long_size_t size){
+				return std::max(K_ViewGranularity, (size + K_ViewGranularity - 1) / K_ViewGranularity * K_ViewGranularity);
+			}
+			long_size_t m_size;
+			long_size_t m_max;
+		};
+	}
 
 	reader::~reader() {}
+	positional_reader::~positional_reader() {}
+	vector_reader::~vector_reader() {}
+	vector_writer::~vector_writer() {}
 	writer::~writer() {}
 	sequence::~sequence() {}
 	forward::~forward() {}
 	random::~random() {}
+	options::~options() {}
 	read_view::~read_view(){}
 	write_view::~write_view(){}
 	read_map::~read_map(){}
 	write_map::~write_map(){}
+	native_handle::~native_handle(){}
+	async_reader::~async_reader(){}
+	async_writer::~async_writer(){}
+
+	access_hint access_hint_of(int of){
+		if (of & of_access_sequential)	return ah_sequential;
+		if (of & of_access_random)		return ah_random;
+		if (of & of_access_willneed)	return ah_willneed;
+		if (of & of_access_dontneed)	return ah_dontneed;
+		return ah_normal;
+	}
 
 	range<reader::iterator> block_read(reader& rd, const range<reader::iterator>& buf)
 	{
@@ -46,11 +99,12 @@ namespace xirang{ namespace io{
 		return nsize;
 	}
 
-	long_size_t copy_data(reader& rd, write_map& wr, long_size_t max_size /*  = ~0 */){
+	long_size_t copy_data(reader& rd, write_map& wr, long_size_t max_size /*  = ~0 */, const view_options& opts /* = view_options() */){
 		long_size_t nsize = 0;
+		view_sizer sizer(opts);
 		while (rd.readable() && nsize < max_size)
 		{
-			auto view = wr.view_wr(ext_heap::handle(nsize, nsize + K_ViewSize));
+			auto view = wr.view_wr(ext_heap::handle(nsize, nsize + std::min(max_size - nsize, sizer.next())));
 			auto buf = view.get<write_view>().address();
 			if (buf.empty())
 				break;
@@ -60,13 +114,14 @@ namespace xirang{ namespace io{
 		wr.truncate(nsize);
 		return nsize;
 	}
-	long_size_t copy_data(read_map& rd, writer& wr, long_size_t max_size  /* = ~0 */){
+	long_size_t copy_data(read_map& rd, writer& wr, long_size_t max_size  /* = ~0 */, const view_options& opts /* = view_options() */){
 		max_size = std::min(max_size, rd.size());
 
 		long_size_t nsize = 0;
+		view_sizer sizer(opts);
 		while (wr.writable() && nsize < max_size)
 		{
-			auto view = rd.view_rd(ext_heap::handle(nsize, std::min(max_size, nsize + K_ViewSize)));
+			auto view = rd.view_rd(ext_heap::handle(nsize, nsize + std::min(max_size - nsize, sizer.next())));
 			auto buf = view.get<read_view>().address();
 			if (buf.empty())
 				break;
@@ -75,14 +130,16 @@ namespace xirang{ namespace io{
 		}
 		return nsize;
 	}
-	long_size_t copy_data(read_map& rd, write_map& wr, long_size_t max_size /*  = ~0*/ ){
+	long_size_t copy_data(read_map& rd, write_map& wr, long_size_t max_size /*  = ~0*/, const view_options& opts /* = view_options() */){
 		max_size = std::min(max_size, rd.size());
 
 		long_size_t nsize = 0;
+		view_sizer sizer(opts);
 		while (nsize < max_size)
 		{
-			auto rview = rd.view_rd(ext_heap::handle(nsize, std::min(max_size, nsize + K_ViewSize)));
-			auto wview = wr.view_wr(ext_heap::handle(nsize, std::min(max_size, nsize + K_ViewSize)));
+			ext_heap::handle h(nsize, nsize + std::min(max_size - nsize, sizer.next()));
+			auto rview = rd.view_rd(h);
+			auto wview = wr.view_wr(h);
 
 			auto rbuf = rview.get<read_view>().address();
 			auto wbuf = wview.get<write_view>().address();
@@ -94,6 +151,190 @@ namespace xirang{ namespace io{
 		return nsize;
 	}
 
+#ifdef __linux__
+	/// copy by kernel, reflink the block aligned part if possible
+	/// \return bytes copied, less than size if kernel copy isn't supported
+	static long_size_t kernel_copy_(int in, long_size_t in_off, int out, long_size_t out_off, long_size_t size){
+		long_size_t copied = 0;
+#ifdef FICLONERANGE
+		const long_size_t K_CloneAlign = 4096;
+		long_size_t clone_size = size - size % K_CloneAlign;
+		if (in_off % K_CloneAlign == 0 && out_off % K_CloneAlign == 0 && clone_size > 0){
+			file_clone_range arg;
+			arg.src_fd = in;
+			arg.src_offset = in_off;
+			arg.src_length = clone_size;
+			arg.dest_offset = out_off;
+			if (::ioctl(out, FICLONERANGE, &arg) == 0)
+				copied = clone_size;
+		}
+#endif
+		while (copied < size){
+			loff_t src = in_off + copied, dest = out_off + copied;
+			ssize_t n = ::copy_file_range(in, &src, out, &dest, size - copied, 0);
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n <= 0)
+				break;
+			copied += n;
+		}
+		while (copied < size){	// e.g. cross file systems on old kernel
+			off_t src = in_off + copied;
+			if (::lseek(out, out_off + copied, SEEK_SET) < 0)
+				break;
+			ssize_t n = ::sendfile(out, in, &src, size - copied);
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n <= 0)
+				break;
+			copied += n;
+		}
+		return copied;
+	}
+#endif
+
+	long_size_t copy_data(const iref<reader, random, native_handle>& rd,
+			const iref<writer, random, native_handle>& wr, long_size_t max_size /* = ~0 */){
+		long_size_t nsize = 0;
+#ifdef __linux__
+		auto& rd_pos = rd.get<random>();
+		auto& wr_pos = wr.get<random>();
+		long_size_t in_off = rd_pos.offset();
+		long_size_t out_off = wr_pos.offset();
+		long_size_t size = rd_pos.size() > in_off ? std::min(max_size, rd_pos.size() - in_off) : 0;
+		if (size > 0){
+			int in = rd.get<native_handle>().handle();
+			int out = wr.get<native_handle>().handle();
+			nsize = kernel_copy_(in, in_off, out, out_off, size);
+			if (nsize > 0){
+				wr.get<native_handle>().handle_written(out_off, out_off + nsize);
+				rd_pos.seek(in_off + nsize);
+				wr_pos.seek(out_off + nsize);
+			}
+		}
+#endif
+		if (nsize < max_size)
+			nsize += copy_data(rd.get<reader>(), wr.get<writer>(), max_size - nsize);
+		return nsize;
+	}
 
-}}
+	namespace {
+		/// buffers shared by producer and consumer of copy_data_pipelined
+		struct pipeline_ring
+		{
+			explicit pipeline_ring(const pipeline_options& opts)
+				: buffers(opts.buffer_count), sizes(opts.buffer_count, 0)
+				, head(0), count(0), eof(false), cancel(false)
+			{
+				for (auto& i : buffers)
+					i.resize(opts.buffer_size);
+			}
+
+			std::vector<buffer<byte>> buffers;
+			std::vector<std::size_t> sizes;	///< valid bytes of each buffer
+			std::size_t head;	///< next buffer to be written
+			std::size_t count;	///< filled buffers
+			bool eof;			///< producer is done
+			bool cancel;		///< consumer is done
+			std::exception_ptr error;
+
+			std::mutex mutex;
+			std::condition_variable cond;
+		};
+
+		void pipeline_produce_(reader& rd, long_size_t max_size, pipeline_ring& ring){
+			try{
+				std::size_t tail = 0;
+				while (max_size > 0){
+					{
+						std::unique_lock<std::mutex> lock(ring.mutex);
+						ring.cond.wait(lock, [&ring]{ return ring.count < ring.buffers.size() || ring.cancel; });
+						if (ring.cancel)
+							break;
+					}
+
+					// buffer tail is owned by producer until it's counted
+					auto& buf = ring.buffers[tail];
+					auto want = std::min<long_size_t>(buf.size(), max_size);
+					auto rest = block_read(rd, make_range(buf.begin(), buf.begin() + want));
+					std::size_t got = std::size_t(want - rest.size());
+					max_size -= got;
+
+					if (got > 0){
+						std::lock_guard<std::mutex> lock(ring.mutex);
+						ring.sizes[tail] = got;
+						++ring.count;
+					}
+					ring.cond.notify_all();
+
+					if (!rest.empty())
+						break;
+					tail = (tail + 1) % ring.buffers.size();
+				}
+			}
+			catch(...){
+				std::lock_guard<std::mutex> lock(ring.mutex);
+				ring.error = std::current_exception();
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(ring.mutex);
+				ring.eof = true;
+			}
+			ring.cond.notify_all();
+		}
+	}
+
+	long_size_t copy_data_pipelined(reader& rd, writer& wr, long_size_t max_size /* = ~0 */,
+			const pipeline_options& opts /* = pipeline_options() */){
+		AIO_PRE_CONDITION(opts.buffer_size > 0 && opts.buffer_count >= 2);
 
+		pipeline_ring ring(opts);
+		std::thread producer(pipeline_produce_, std::ref(rd), max_size, std::ref(ring));
+
+		auto stop_producer = [&ring, &producer]{
+			{
+				std::lock_guard<std::mutex> lock(ring.mutex);
+				ring.cancel = true;
+			}
+			ring.cond.notify_all();
+			producer.join();
+		};
+
+		long_size_t nsize = 0;
+		try{
+			for (;;){
+				std::size_t size = 0;
+				{
+					std::unique_lock<std::mutex> lock(ring.mutex);
+					ring.cond.wait(lock, [&ring]{ return ring.count > 0 || ring.eof; });
+					if (ring.count == 0)
+						break;
+					size = ring.sizes[ring.head];
+				}
+
+				auto& buf = ring.buffers[ring.head];
+				auto rest = block_write(wr, make_range(buf.begin(), buf.begin() + size));
+				nsize += size - rest.size();
+				if (!rest.empty())
+					break;
+
+				{
+					std::lock_guard<std::mutex> lock(ring.mutex);
+					ring.head = (ring.head + 1) % ring.buffers.size();
+					--ring.count;
+				}
+				ring.cond.notify_all();
+			}
+		}
+		catch(...){
+			stop_producer();
+			throw;
+		}
+
+		stop_producer();
+		if (ring.error)
+			std::rethrow_exception(ring.error);
+		return nsize;
+	}
+}}
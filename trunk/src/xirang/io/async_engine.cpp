@@ -0,0 +1,438 @@
+#include "async_engine.h"
+
+#ifndef WIN32
+
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <chrono>
+
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define XIRANG_IO_URING
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#endif
+#endif
+
+namespace xirang{ namespace io{ namespace private_{
+
+	async_engine::~async_engine(){}
+
+	namespace {
+		/// count of worker threads of thread pool engine
+		const std::size_t K_AsyncWorkerCount = 16;
+		/// submission queue entries of io_uring engine, it's also the max requests in flight.
+		const unsigned K_AsyncQueueDepth = 128;
+		/// max bytes of one io_uring read or write
+		const std::size_t K_MaxTransferSize = 1 << 30;
+		/// retries of io_uring_enter on EAGAIN or EBUSY before the request fails, backoff from 1us to 1ms
+		const unsigned K_MaxSubmitRetry = 20;
+
+		void throw_transfer_error_(bool is_write){
+			if (is_write)
+				AIO_THROW(write_exception)("failed to write file asynchronously");
+			AIO_THROW(read_exception)("failed to read file asynchronously");
+		}
+
+		/// pread/pwrite until size bytes or the end of file
+		long_size_t transfer_(native_handle_t h, long_size_t off, byte* buf, std::size_t size, bool is_write){
+			std::size_t total = 0;
+			while (total < size)
+			{
+				ssize_t n = is_write
+					? ::pwrite(h, buf + total, size - total, off_t(off + total))
+					: ::pread(h, buf + total, size - total, off_t(off + total));
+				if (n < 0 && errno == EINTR)
+					continue;
+				if (n < 0 || (n == 0 && is_write))
+					throw_transfer_error_(is_write);
+				if (n == 0)
+					break;
+				total += n;
+			}
+			return total;
+		}
+
+		/// runs the blocking calls in worker threads
+		class thread_pool_engine : public async_engine
+		{
+			public:
+			explicit thread_pool_engine(std::size_t count) : m_stop(false)
+			{
+				for (std::size_t i = 0; i < count; ++i)
+					m_workers.push_back(std::thread([this]{ run_(); }));
+			}
+			~thread_pool_engine()
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_stop = true;
+				}
+				m_cond.notify_all();
+				for (auto& t : m_workers)
+					t.join();
+			}
+
+			virtual async_result read(native_handle_t h, long_size_t off, byte* buf, std::size_t size){
+				return submit_(h, off, buf, size, false);
+			}
+			virtual async_result write(native_handle_t h, long_size_t off, const byte* buf, std::size_t size){
+				return submit_(h, off, const_cast<byte*>(buf), size, true);
+			}
+			virtual engine_kind kind() const { return ek_thread_pool;}
+
+			private:
+			async_result submit_(native_handle_t h, long_size_t off, byte* buf, std::size_t size, bool is_write)
+			{
+				std::packaged_task<long_size_t()> task([=]{ return transfer_(h, off, buf, size, is_write); });
+				auto ret = task.get_future();
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_tasks.push_back(std::move(task));
+				}
+				m_cond.notify_one();
+				return ret;
+			}
+
+			/// the pending tasks are done before exit
+			void run_()
+			{
+				for (;;)
+				{
+					std::packaged_task<long_size_t()> task;
+					{
+						std::unique_lock<std::mutex> lock(m_mutex);
+						m_cond.wait(lock, [this]{ return m_stop || !m_tasks.empty(); });
+						if (m_tasks.empty())
+							return;
+						task = std::move(m_tasks.front());
+						m_tasks.pop_front();
+					}
+					task();
+				}
+			}
+
+			std::mutex m_mutex;
+			std::condition_variable m_cond;
+			std::deque<std::packaged_task<long_size_t()>> m_tasks;
+			std::vector<std::thread> m_workers;
+			bool m_stop;
+		};
+
+#ifdef XIRANG_IO_URING
+		int io_uring_setup_(unsigned entries, io_uring_params* p){
+			return int(::syscall(__NR_io_uring_setup, entries, p));
+		}
+		int io_uring_enter_(int fd, unsigned to_submit, unsigned min_complete, unsigned flags){
+			return int(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+		}
+		int io_uring_register_(int fd, unsigned op, void* arg, unsigned nr){
+			return int(::syscall(__NR_io_uring_register, fd, op, arg, nr));
+		}
+
+		/// submits requests to an io_uring instance, a reaper thread waits the completions.
+		/// short transfers are resubmitted for the rest part.
+		class io_uring_engine : public async_engine
+		{
+			struct request
+			{
+				std::promise<long_size_t> result;
+				native_handle_t handle;
+				long_size_t off;
+				byte* buf;
+				std::size_t size;
+				std::size_t done;
+				bool is_write;
+			};
+
+			public:
+			/// \return null if io_uring or its read/write operation is not supported
+			static std::unique_ptr<async_engine> create(unsigned entries)
+			{
+				std::unique_ptr<io_uring_engine> ret(new io_uring_engine);
+				if (!ret->init_(entries))
+					return std::unique_ptr<async_engine>();
+				io_uring_engine* self = ret.get();
+				ret->m_reaper = std::thread([self]{ self->reap_(); });
+				return std::move(ret);
+			}
+
+			~io_uring_engine()
+			{
+				if (m_reaper.joinable())
+				{
+					bool woken = true;
+					{
+						std::lock_guard<std::mutex> lock(m_mutex);
+						m_stop = true;
+						// wake up the reaper, or the last request in flight will do
+						woken = push_sqe_(IORING_OP_NOP, 0, 0, 0, 0, 0) || m_in_flight != 0;
+					}
+					if (!woken)
+					{
+						// the reaper waits for a completion forever, leak the ring rather than hang or unmap it under the reaper
+						m_reaper.detach();
+						return;
+					}
+					m_reaper.join();
+				}
+				if (m_sqes != MAP_FAILED)
+					::munmap(m_sqes, m_sqes_size);
+				if (m_ring != MAP_FAILED)
+					::munmap(m_ring, m_ring_size);
+				if (m_fd >= 0)
+					::close(m_fd);
+			}
+
+			virtual async_result read(native_handle_t h, long_size_t off, byte* buf, std::size_t size){
+				return submit_(h, off, buf, size, false);
+			}
+			virtual async_result write(native_handle_t h, long_size_t off, const byte* buf, std::size_t size){
+				return submit_(h, off, const_cast<byte*>(buf), size, true);
+			}
+			virtual engine_kind kind() const { return ek_io_uring;}
+
+			private:
+			io_uring_engine()
+				: m_fd(-1), m_ring(MAP_FAILED), m_ring_size(0), m_sqes(MAP_FAILED), m_sqes_size(0)
+				  , m_capacity(0), m_in_flight(0), m_stop(false)
+			{}
+
+			bool init_(unsigned entries)
+			{
+				io_uring_params params;
+				memset(&params, 0, sizeof(params));
+				m_fd = io_uring_setup_(entries, &params);
+				if (m_fd < 0 || (params.features & IORING_FEAT_SINGLE_MMAP) == 0)
+					return false;
+
+				m_ring_size = std::max<std::size_t>(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+						params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+				m_ring = ::mmap(0, m_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+				if (m_ring == MAP_FAILED)
+					return false;
+				m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+				m_sqes = ::mmap(0, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES);
+				if (m_sqes == MAP_FAILED)
+					return false;
+
+				char* ring = reinterpret_cast<char*>(m_ring);
+				m_sq_tail = reinterpret_cast<unsigned*>(ring + params.sq_off.tail);
+				m_sq_mask = *reinterpret_cast<unsigned*>(ring + params.sq_off.ring_mask);
+				m_sq_array = reinterpret_cast<unsigned*>(ring + params.sq_off.array);
+				m_cq_head = reinterpret_cast<unsigned*>(ring + params.cq_off.head);
+				m_cq_tail = reinterpret_cast<unsigned*>(ring + params.cq_off.tail);
+				m_cq_mask = *reinterpret_cast<unsigned*>(ring + params.cq_off.ring_mask);
+				m_cqes = reinterpret_cast<io_uring_cqe*>(ring + params.cq_off.cqes);
+
+				// the CQ has at least as many entries as the SQ, one is reserved for the wake up NOP
+				m_capacity = params.sq_entries - 1;
+
+				std::vector<char> probe_buf(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op));
+				io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(probe_buf.data());
+				if (io_uring_register_(m_fd, IORING_REGISTER_PROBE, probe, 256) < 0
+						|| probe->last_op < IORING_OP_WRITE
+						|| (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED) == 0
+						|| (probe->ops[IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED) == 0)
+					return false;
+				return true;
+			}
+
+			async_result submit_(native_handle_t h, long_size_t off, byte* buf, std::size_t size, bool is_write)
+			{
+				std::unique_ptr<request> req(new request);
+				req->handle = h;
+				req->off = off;
+				req->buf = buf;
+				req->size = size;
+				req->done = 0;
+				req->is_write = is_write;
+				auto ret = req->result.get_future();
+				if (size == 0)
+				{
+					req->result.set_value(0);
+					return ret;
+				}
+
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_slot_cond.wait(lock, [this]{ return m_in_flight < m_capacity; });
+				++m_in_flight;
+				request* pushed = req.release();
+				if (!push_request_(pushed))
+				{
+					lock.unlock();
+					finish_(pushed, true);
+				}
+				return ret;
+			}
+
+			/// \pre m_mutex is locked
+			/// \return false if failed to submit
+			bool push_request_(request* req)
+			{
+				std::size_t len = std::min(req->size - req->done, K_MaxTransferSize);
+				return push_sqe_(req->is_write ? IORING_OP_WRITE : IORING_OP_READ, req->handle,
+						req->off + req->done, req->buf + req->done, unsigned(len), req);
+			}
+
+			/// \pre m_mutex is locked
+			/// \return false if failed to submit, the sqe is taken back from the ring
+			bool push_sqe_(int op, int fd, long_size_t off, byte* addr, unsigned len, request* req)
+			{
+				unsigned tail = *m_sq_tail;	// only written here
+				unsigned index = tail & m_sq_mask;
+				io_uring_sqe& sqe = reinterpret_cast<io_uring_sqe*>(m_sqes)[index];
+				memset(&sqe, 0, sizeof(sqe));
+				sqe.opcode = op;
+				sqe.fd = fd;
+				sqe.off = off;
+				sqe.addr = reinterpret_cast<unsigned long long>(addr);
+				sqe.len = len;
+				sqe.user_data = reinterpret_cast<unsigned long long>(req);
+				m_sq_array[index] = index;
+				__atomic_store_n(m_sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+				for (unsigned retry = 0; ; )
+				{
+					int n = io_uring_enter_(m_fd, 1, 0, 0);
+					if (n == 1)
+						return true;
+					if (n < 0 && errno == EINTR)
+						continue;
+					// short of kernel resources or completion queue is full, give the reaper a chance
+					if (n < 0 && (errno == EAGAIN || errno == EBUSY) && retry < K_MaxSubmitRetry)
+					{
+						std::this_thread::sleep_for(std::chrono::microseconds(1 << std::min(retry, 10u)));
+						++retry;
+						continue;
+					}
+					break;
+				}
+				// the kernel consumes sqes in io_uring_enter only, which is serialized by m_mutex
+				__atomic_store_n(m_sq_tail, tail, __ATOMIC_RELEASE);
+				return false;
+			}
+
+			void reap_()
+			{
+				for (;;)
+				{
+					if (io_uring_enter_(m_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+						break;
+
+					unsigned head = *m_cq_head;	// only written here
+					unsigned tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+					for (; head != tail; ++head)
+					{
+						const io_uring_cqe& cqe = m_cqes[head & m_cq_mask];
+						complete_(reinterpret_cast<request*>(cqe.user_data), cqe.res);
+					}
+					__atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+
+					std::lock_guard<std::mutex> lock(m_mutex);
+					if (m_stop && m_in_flight == 0)
+						break;
+				}
+			}
+
+			void complete_(request* req, int res)
+			{
+				if (req == 0)	// NOP
+					return;
+
+				if (res > 0)
+					req->done += res;
+
+				bool again = res == -EINTR || res == -EAGAIN
+					|| (res > 0 && req->done < req->size);
+				if (again)
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					if (push_request_(req))
+						return;
+				}
+
+				// failed to resubmit, or done or reach the end of file
+				finish_(req, again || res < 0 || (res == 0 && req->is_write));
+			}
+
+			/// set the result, release the slot of req
+			/// \pre m_mutex is not locked
+			void finish_(request* req, bool failed)
+			{
+				if (failed)
+				{
+					try{
+						throw_transfer_error_(req->is_write);
+					}
+					catch(...){
+						req->result.set_exception(std::current_exception());
+					}
+				}
+				else
+					req->result.set_value(req->done);
+				delete req;
+
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					--m_in_flight;
+				}
+				m_slot_cond.notify_one();
+			}
+
+			int m_fd;
+			void* m_ring;
+			std::size_t m_ring_size;
+			void* m_sqes;
+			std::size_t m_sqes_size;
+
+			unsigned* m_sq_tail;
+			unsigned m_sq_mask;
+			unsigned* m_sq_array;
+			unsigned* m_cq_head;
+			unsigned* m_cq_tail;
+			unsigned m_cq_mask;
+			io_uring_cqe* m_cqes;
+
+			std::mutex m_mutex;
+			std::condition_variable m_slot_cond;
+			unsigned m_capacity;
+			unsigned m_in_flight;
+			bool m_stop;
+			std::thread m_reaper;
+		};
+#endif
+	}
+
+	std::unique_ptr<async_engine> async_engine::create(engine_kind kind)
+	{
+#ifdef XIRANG_IO_URING
+		if (kind != ek_thread_pool)
+		{
+			auto ret = io_uring_engine::create(K_AsyncQueueDepth);
+			if (ret || kind == ek_io_uring)
+				return ret;
+		}
+#else
+		if (kind == ek_io_uring)
+			return std::unique_ptr<async_engine>();
+#endif
+		return std::unique_ptr<async_engine>(new thread_pool_engine(K_AsyncWorkerCount));
+	}
+
+	async_engine& async_engine::instance()
+	{
+		static std::unique_ptr<async_engine> engine = create(ek_auto);
+		return *engine;
+	}
+}}}
+#endif
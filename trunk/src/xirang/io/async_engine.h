@@ -0,0 +1,41 @@
+#ifndef AIO_IO_ASYNC_ENGINE_H
+#define AIO_IO_ASYNC_ENGINE_H
+
+#include <xirang/io.h>
+
+#include <memory>
+
+namespace xirang{ namespace io{ namespace private_{
+
+#ifndef WIN32
+	/// executes positional reads and writes on native handles asynchronously.
+	class async_engine
+	{
+		public:
+		enum engine_kind
+		{
+			ek_auto,			///< io_uring if the kernel supports it, otherwise thread pool
+			ek_io_uring,
+			ek_thread_pool
+		};
+
+		/// read up to size bytes at off, the result is less than size only if reach the end of file.
+		virtual async_result read(native_handle_t h, long_size_t off, byte* buf, std::size_t size) = 0;
+
+		/// write size bytes at off.
+		virtual async_result write(native_handle_t h, long_size_t off, const byte* buf, std::size_t size) = 0;
+
+		virtual engine_kind kind() const = 0;
+
+		virtual ~async_engine();
+
+		/// \return null if the kind is not supported
+		static std::unique_ptr<async_engine> create(engine_kind kind);
+
+		/// the process wide engine, created by ek_auto
+		static async_engine& instance();
+	};
+#endif
+
+}}}
+#endif //end AIO_IO_ASYNC_ENGINE_H
@@ -7,6 +7,19 @@
 #include <boost/numeric/conversion/cast.hpp>
 #include <xirang/string_algo/utf8.h>
 #include <xirang/fsutility.h>
+#include "async_engine.h"
+
+#include <vector>
+
+#ifndef WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
+#endif
 
 namespace xirang{ namespace io{
 
@@ -14,12 +27,46 @@ namespace xirang{ namespace io{
 	namespace bi = boost::interprocess;
 	using boost::numeric_cast;
 
+	/// map access_hint to the advice of mapped_region
+	static mapped_region::advice_types to_advice_(access_hint hint)
+	{
+		static const mapped_region::advice_types advice[] = { mapped_region::advice_normal, mapped_region::advice_sequential
+			, mapped_region::advice_random, mapped_region::advice_willneed, mapped_region::advice_dontneed };
+		return advice[hint];
+	}
+
+	/// map [offset, offset + size) of file, apply of_map_populate and of_map_hugepage of of
+	static mapped_region map_region_(const file_mapping& file, bi::mode_t mode, offset_t offset, std::size_t size, int of)
+	{
+		map_options_t options = default_map_options;
+#ifdef MAP_POPULATE
+		if (of & of_map_populate)
+			options = MAP_POPULATE;
+#endif
+		mapped_region region(file, mode, offset, size, 0, options);
+#ifdef MADV_HUGEPAGE
+		if ((of & of_map_hugepage) && size > 0)
+		{
+			// the address is adjusted by the page offset of offset
+			std::size_t page_size = mapped_region::get_page_size();
+			std::size_t addr = reinterpret_cast<std::size_t>(region.get_address());
+			std::size_t first = addr - addr % page_size;
+			::madvise(reinterpret_cast<void*>(first), addr + size - first, MADV_HUGEPAGE);	// best effort
+		}
+#endif
+		return region;
+	}
+
 	struct read_file_view : read_view{
-			read_file_view(file_mapping& file, bi::mode_t mode, offset_t offset, std::size_t size)
+			read_file_view(file_mapping& file, bi::mode_t mode, offset_t offset, std::size_t size, access_hint hint = ah_normal, int of = 0)
 				: m_offset(offset), m_size(size)
 			{
 				if (size > 0)
-					m_region = mapped_region(file, mode, offset, size);	
+				{
+					m_region = map_region_(file, mode, offset, size, of);
+					if (hint != ah_normal)
+						m_region.advise(to_advice_(hint));
+				}
 			}
 			virtual range<const byte*> address() const{ 
 				if (m_size == 0)
@@ -34,8 +81,8 @@ namespace xirang{ namespace io{
 			std::size_t m_size;
 	};
 	struct write_file_view : write_view{
-			write_file_view(file_mapping& file, bi::mode_t mode, offset_t offset, std::size_t size)
-				: m_region(file, mode, offset, size), m_offset(offset)
+			write_file_view(file_mapping& file, bi::mode_t mode, offset_t offset, std::size_t size, int of = 0)
+				: m_region(map_region_(file, mode, offset, size, of)), m_offset(offset)
 			{}
 			virtual range<byte*> address() const{ 
 				byte* first = reinterpret_cast<byte*>(m_region.get_address());
@@ -46,14 +93,40 @@ namespace xirang{ namespace io{
 			offset_t m_offset;
 	};
 
+	/// default size of a cached mapping window
+	const std::size_t K_MapWindowSize = 1024 * 1024;
+	/// default max count of cached mapping windows
+	const std::size_t K_MapWindowCount = 4;
+	/// min and max growth step of preallocated capacity, see of_preallocate
+	const long_size_t K_MinReserveStep = 1024 * 1024;
+	const long_size_t K_MaxReserveStep = 64 * 1024 * 1024;
+
+	/// a cached mapping of file range [first, last)
+	struct map_window
+	{
+		map_window() : first(0), last(0), tick(0){}
+
+		long_size_t first;
+		long_size_t last;
+		long_size_t tick;	///< last used time, for LRU
+		mapped_region region;
+	};
+
+	/// backend of file, file_reader and file_writer
 	struct file_imp
 	{
 		typedef reader::iterator iterator;
 		typedef writer::const_iterator const_iterator;
 
-		file_imp(const file_path& path, int of, bi::mode_t mode)
-			: m_path(path), m_pos(0), m_mode(mode), m_file_size(0), m_flag(of)
+		file_imp(const file_path& path, int of)
+			: m_path(path), m_pos(0), m_file_size(0), m_flag(of)
+			, m_sync_policy(sp_none), m_dirty_first(0), m_dirty_last(0), m_access_hint(access_hint_of(of))
 		{
+			if (of & of_sync_durable)
+				m_sync_policy = sp_durable;
+			else if (of & of_sync_async)
+				m_sync_policy = sp_async;
+
 			switch (of & of_low_mask)
 			{
 				case of_open:
@@ -74,10 +147,242 @@ namespace xirang{ namespace io{
 				default:
 					AIO_PRE_CONDITION(false);
 			}
+			m_file_size = get_file_size_();
+		}
+		virtual ~file_imp(){}
+
+		virtual range<iterator> read(const range<iterator>& buf) = 0;
+		virtual range<iterator> read_at(long_size_t off, const range<iterator>& buf) const = 0;
+		bool readable() const { return m_pos < m_file_size; }
+
+		virtual range<const_iterator> write(const range<const_iterator>& r) = 0;
+		virtual long_size_t truncate(long_size_t nsize) = 0;
 
+		/// default readv/writev, loop over read/write
+		virtual long_size_t readv(const range<const range<iterator>*>& bufs)
+		{
+			long_size_t total = 0;
+			for (auto& buf : bufs)
+			{
+				auto rest = read(buf);
+				total += buf.size() - rest.size();
+				if (!rest.empty())
+					break;
+			}
+			return total;
+		}
+		virtual long_size_t writev(const range<const range<const_iterator>*>& bufs)
+		{
+			long_size_t total = 0;
+			for (auto& buf : bufs)
+				total += buf.size() - write(buf).size();
+			return total;
+		}
+
+		bool writable() const { return true;}
+		virtual void sync() = 0;
+
+		virtual unique_ptr<write_view> view_wr(ext_heap::handle h) = 0;
+		virtual unique_ptr<read_view> view_rd(ext_heap::handle h) = 0;
+
+		virtual native_handle_t handle() = 0;
+		virtual void handle_written(long_size_t first, long_size_t last) = 0;
+
+		/// submit to the process wide async engine through the native handle
+		async_result async_read(long_size_t off, const range<iterator>& buf)
+		{
+			long_size_t size = off < m_file_size ? std::min<long_size_t>(buf.size(), m_file_size - off) : 0;
+#ifndef WIN32
+			native_handle_t h = handle();
+			return private_::async_engine::instance().read(h, off, buf.begin(), numeric_cast<std::size_t>(size));
+#else
+			std::promise<long_size_t> ret;
+			read_at(off, range<iterator>(buf.begin(), buf.begin() + size));
+			ret.set_value(size);
+			return ret.get_future();
+#endif
+		}
+		async_result async_write(long_size_t off, const range<const_iterator>& buf)
+		{
+#ifndef WIN32
+			native_handle_t h = handle();
+			async_written_(off, off + buf.size());
+			return private_::async_engine::instance().write(h, off, buf.begin(), buf.size());
+#else
+			std::promise<long_size_t> ret;
+			long_size_t pos = m_pos;
+			m_pos = off;
+			write(buf);
+			m_pos = pos;
+			ret.set_value(buf.size());
+			return ret.get_future();
+#endif
+		}
+
+		long_size_t offset() const { return m_pos; }
+		long_size_t size() const { return m_file_size;}
+		long_size_t seek(long_size_t offset) 
+		{
+			m_pos = offset;
+			return m_pos;
+		}
+
+		virtual any getopt(int id, const any & /* optdata */) const
+		{
+			if (id == ao_sync_policy)
+				return any(m_sync_policy);
+			if (id == ao_access_hint)
+				return any(m_access_hint);
+			return any();
+		}
+
+		virtual any setopt(int id, const any & optdata,  const any & indata)
+		{
+			if (id == ao_sync_policy)
+			{
+				m_sync_policy = any_cast<sync_policy>(optdata);
+				return any(m_sync_policy);
+			}
+			if (id == ao_access_hint)
+			{
+				auto hint = any_cast<access_hint>(optdata);
+				if (indata.empty())
+				{
+					m_access_hint = hint;
+					advise_(hint, 0, 0);
+				}
+				else
+				{
+					auto h = any_cast<ext_heap::handle>(indata);
+					AIO_PRE_CONDITION(h.begin() >= 0 && h.begin() <= h.end());
+					if (!h.empty())
+						advise_(hint, h.begin(), h.end());
+				}
+				return any(hint);
+			}
+			return any();
+		}
+
+		/// pass the hint of range [first, last) to OS, last == 0 means to the end of file.
+		virtual void advise_(access_hint hint, long_size_t first, long_size_t last) = 0;
+
+		/// [first, last) will be written via handle asynchronously
+		virtual void async_written_(long_size_t first, long_size_t last)
+		{
+			handle_written(first, last);
+		}
+
+		protected:
+		bool exists_()
+		{
+			
+			return fs::exists(m_path);
+		}
+
+		void create_()
+		{
+#ifdef WIN32
+            wstring wpath = m_path.native_wstr();
+			FILE* fp = _wfopen(wpath.c_str(), L"wb");
+#else
+            FILE* fp = fopen(m_path.str().c_str(),"wb");
+#endif
+			if (fp == 0)
+				AIO_THROW(fs::create_exception)(m_path.str());
+
+			fclose(fp);
+		}
+
+		long_size_t get_file_size_()
+		{
+			
+			auto st = fs::state(m_path);
+			if (st.state == fs::st_not_found)
+				AIO_THROW(fs::not_found_exception)(m_path.str());
+			return st.size;
+		}
+
+		/// extend the range need to be flushed by next sync()
+		void mark_dirty_(long_size_t first, long_size_t last)
+		{
+			if (m_dirty_first >= m_dirty_last)
+			{
+				m_dirty_first = first;
+				m_dirty_last = last;
+			}
+			else
+			{
+				m_dirty_first = std::min(m_dirty_first, first);
+				m_dirty_last = std::max(m_dirty_last, last);
+			}
+		}
+
+#ifndef WIN32
+		/// flush the dirty range via fd according to the sync policy
+		void sync_fd_(int fd)
+		{
+			if (m_sync_policy == sp_async)
+			{
+#ifdef __linux__
+				::sync_file_range(fd, m_dirty_first, m_dirty_last - m_dirty_first, SYNC_FILE_RANGE_WRITE);
+#endif
+			}
+			else if (m_sync_policy == sp_durable && ::fdatasync(fd) != 0)
+				AIO_THROW(write_exception)("failed to sync file:")(m_path.str());
+		}
+
+		/// posix_fadvise range [first, last), last == 0 means to the end of file.
+		void fadvise_fd_(int fd, access_hint hint, long_size_t first, long_size_t last)
+		{
+#ifdef __linux__
+			static const int advice[] = { POSIX_FADV_NORMAL, POSIX_FADV_SEQUENTIAL, POSIX_FADV_RANDOM
+				, POSIX_FADV_WILLNEED, POSIX_FADV_DONTNEED };
+			// it's only a hint, ignore the error
+			::posix_fadvise(fd, numeric_cast<off_t>(first), numeric_cast<off_t>(last == 0 ? 0 : last - first), advice[hint]);
+#endif
+		}
+
+		/// pread until size bytes or the end of file, doesn't touch any member except m_path.
+		/// \return the bytes read
+		long_size_t pread_fd_(int fd, long_size_t pos, byte* dest, long_size_t size) const
+		{
+			long_size_t total = 0;
+			while (total < size)
+			{
+				ssize_t n = ::pread(fd, dest + total, numeric_cast<std::size_t>(size - total), numeric_cast<off_t>(pos + total));
+				if (n < 0 && errno == EINTR)
+					continue;
+				if (n < 0)
+					AIO_THROW(read_exception)("failed to read file:")(m_path.str());
+				if (n == 0)
+					break;
+				total += n;
+			}
+			return total;
+		}
+#endif
+
+		file_path m_path;
+		long_size_t m_pos;
+		long_size_t m_file_size;	///< logical size
+        int m_flag;
+
+		sync_policy m_sync_policy;
+		long_size_t m_dirty_first;	///< [m_dirty_first, m_dirty_last) need to be flushed
+		long_size_t m_dirty_last;
+		access_hint m_access_hint;	///< hint of whole file
+	};
+
+	/// file_imp based on file mapping
+	struct mapped_file_imp : file_imp
+	{
+		mapped_file_imp(const file_path& path, int of, bi::mode_t mode)
+			: file_imp(path, of), m_mode(mode), m_capacity(0)
+			, m_window_size(K_MapWindowSize), m_windows(K_MapWindowCount), m_tick(0), m_map_count(0)
+		{
 			try
 			{
-				m_file_size = get_file_size_();
+				m_capacity = m_file_size;
 #ifdef WIN32
 				m_file = file_mapping(m_path.native_wstr().c_str(), mode);
 #else
@@ -88,9 +393,12 @@ namespace xirang{ namespace io{
 			{
 				AIO_THROW(fs::open_failed_exception)(m_path.str());
 			}
+			if (m_access_hint != ah_normal)
+				advise_(m_access_hint, 0, 0);
 		}
-        ~file_imp()
+        ~mapped_file_imp()
         {
+			reset_windows_(0);
             if (m_flag & of_remove_on_close)
             {
 				file_mapping(std::move(m_file)); //close file_mapping first;
@@ -98,21 +406,21 @@ namespace xirang{ namespace io{
             }
             else
             {
-                sync();
+				// destructor must not throw, call sync() explicitly to get the errors
+				try { sync(); }
+				catch(...) {}
             }
         }
-		range<iterator> read(const range<iterator>& buf)
+		virtual range<iterator> read(const range<iterator>& buf)
 		{
 			AIO_PRE_CONDITION(m_pos <= m_file_size);
 
-			long_size_t buf_size = buf.size();
 			iterator itr = buf.begin();
-			if (buf_size > 0 && readable() )
+			while (itr != buf.end() && readable())
 			{
-				long_size_t view_size = std::min(buf_size, m_file_size - m_pos);
-				mapped_region reg(m_file, m_mode, numeric_cast<std::size_t>(m_pos), numeric_cast<std::size_t>(view_size));
+				long_size_t view_size = std::min<long_size_t>(buf.end() - itr, m_file_size - m_pos);
+				const byte* psrc = map_(m_pos, view_size);
 
-				const byte* psrc = (const byte*)reg.get_address();
 				std::copy(psrc, psrc + view_size, itr);
 
 				itr += view_size;
@@ -121,9 +429,26 @@ namespace xirang{ namespace io{
 			return range<iterator>(itr, buf.end());
 		}
 
-		bool readable() const { return m_pos < m_file_size; }
+		/// bypass the window cache, so it's safe to be called concurrently.
+		virtual range<iterator> read_at(long_size_t off, const range<iterator>& buf) const
+		{
+			if (off >= m_file_size)
+				return buf;
+
+			long_size_t size = std::min<long_size_t>(buf.size(), m_file_size - off);
+#ifdef WIN32
+			mapped_region region(m_file, read_only, off, numeric_cast<std::size_t>(size));
+			const byte* psrc = reinterpret_cast<const byte*>(region.get_address());
+			std::copy(psrc, psrc + size, buf.begin());
+#else
+			// shared mapping and pread see the same page cache
+			long_size_t n = pread_fd_(m_file.get_mapping_handle().handle, off, buf.begin(), size);
+			std::fill(buf.begin() + n, buf.begin() + size, byte(0));
+#endif
+			return range<iterator>(buf.begin() + size, buf.end());
+		}
 
-		range<const_iterator> write(const range<const_iterator>& r)
+		virtual range<const_iterator> write(const range<const_iterator>& r)
 		{
 			long_size_t buf_size = r.size();
 			if (buf_size > 0)
@@ -131,44 +456,476 @@ namespace xirang{ namespace io{
 				long_size_t new_pos = m_pos + buf_size;
 				if (new_pos > m_file_size)
 				{
-					truncate(new_pos);
+					extend_(new_pos);
+				}
+				mark_dirty_(m_pos, new_pos);
+				for (const_iterator itr = r.begin(); itr != r.end();)
+				{
+					long_size_t view_size = r.end() - itr;
+					byte* pdest = map_(m_pos, view_size);
+					std::copy(itr, itr + view_size, pdest);
+
+					itr += view_size;
+					m_pos += view_size;
 				}
-				mapped_region reg(m_file, m_mode, numeric_cast<std::size_t>(m_pos), numeric_cast<size_t>(buf_size));
-				byte* pdest = (byte*)reg.get_address();
-				std::copy(r.begin(), r.end(), pdest);
-				m_pos = new_pos;
 			}
 			return range<const_iterator>(r.end(), r.end());
 		}
 
-		long_size_t truncate(long_size_t nsize)
+		virtual long_size_t truncate(long_size_t nsize)
+		{
+			resize_file_(nsize);
+			m_file_size = nsize;
+			if (m_pos > m_file_size)
+				m_pos = m_file_size;
+
+			return m_file_size;
+		}
+		virtual void sync() 
+		{ 
+			trim_();
+			if (m_sync_policy == sp_none || m_dirty_first >= m_dirty_last)
+				return;
+
+			bool async = m_sync_policy == sp_async;
+			for (auto& w : m_windows)
+			{
+				if (w.first < m_dirty_last && m_dirty_first < w.last)
+					w.region.flush(0, 0, async);
+			}
+#ifndef WIN32
+			sync_fd_(m_file.get_mapping_handle().handle);
+#endif
+			m_dirty_first = m_dirty_last = 0;
+		}
+		/// mapped data is shared with the file, no need to flush.
+		virtual native_handle_t handle()
+		{
+			return native_handle_t(m_file.get_mapping_handle().handle);
+		}
+		virtual void handle_written(long_size_t first, long_size_t last)
+		{
+			mark_dirty_(first, last);
+			m_capacity = std::max(m_capacity, last);
+			m_file_size = std::max(m_file_size, last);
+		}
+		/// extend the file before submission, the windows must not be mapped beyond the physical size
+		virtual void async_written_(long_size_t first, long_size_t last)
+		{
+			if (last > m_file_size)
+				extend_(last);
+			mark_dirty_(first, last);
+		}
+
+		virtual unique_ptr<write_view> view_wr(ext_heap::handle h)
+		{
+			AIO_PRE_CONDITION(h.begin() >= 0);
+			if (m_file_size < numeric_cast<long_size_t>(h.end()))
+				extend_(h.end());
+			mark_dirty_(h.begin(), h.end());
+
+			return unique_ptr<write_view>(new write_file_view(m_file, m_mode, h.begin(), numeric_cast<std::size_t>(h.size()), m_flag));
+		}
+
+		virtual unique_ptr<read_view> view_rd(ext_heap::handle h)
+		{
+			AIO_PRE_CONDITION(h.begin() >= 0);
+			AIO_PRE_CONDITION(h.empty() || numeric_cast<long_size_t>(h.begin()) < m_file_size);
+
+			if (m_file_size < numeric_cast<long_size_t>(h.end()) )
+				h = ext_heap::handle(h.begin(), m_file_size);
+
+			return unique_ptr<read_view>(new read_file_view(m_file, m_mode, h.begin(), numeric_cast<std::size_t>(h.size()), m_access_hint, m_flag));
+		}
+
+		/// advise the page cache and the cached windows overlapping [first, last)
+		virtual void advise_(access_hint hint, long_size_t first, long_size_t last)
+		{
+#ifndef WIN32
+			fadvise_fd_(m_file.get_mapping_handle().handle, hint, first, last);
+#endif
+			for (auto& w : m_windows)
+			{
+				if (w.first < w.last && (last == 0 || w.first < last) && first < w.last)
+					w.region.advise(to_advice_(hint));
+			}
+		}
+
+		virtual any getopt(int id, const any & optdata) const
+		{
+			switch(id)
+			{
+				case ao_map_window_size:
+					return any(m_window_size);
+				case ao_map_window_count:
+					return any(m_windows.size());
+				case ao_map_count:
+					return any(m_map_count);
+			}
+			return file_imp::getopt(id, optdata);
+		}
+
+		virtual any setopt(int id, const any & optdata,  const any & indata)
+		{
+			switch(id)
+			{
+				case ao_map_window_size:
+					{
+						std::size_t page_size = mapped_region::get_page_size();
+						std::size_t wsize = std::max(any_cast<std::size_t>(optdata), page_size);
+						reset_windows_(0);
+						m_window_size = (wsize + page_size - 1) / page_size * page_size;
+						return any(m_window_size);
+					}
+				case ao_map_window_count:
+					reset_windows_(0);
+					m_windows.resize(any_cast<std::size_t>(optdata));
+					return any(m_windows.size());
+			}
+			return file_imp::setopt(id, optdata, indata);
+		}
+
+        private:
+		/// map the range [pos, pos + size), reuse the cached windows if possible.
+		/// \param size in: expected size, out: the mapped size, maybe less than expected one.
+		/// \pre size > 0 && pos + size <= m_capacity
+		/// \return the address of pos, valid until next call of map_ or reset_windows_.
+		byte* map_(long_size_t pos, long_size_t& size)
+		{
+			AIO_PRE_CONDITION(size > 0 && pos + size <= m_capacity);
+
+			if (m_windows.empty())	// cache disabled, map the given range only
+			{
+				m_scratch = map_region_(m_file, m_mode, numeric_cast<offset_t>(pos), numeric_cast<std::size_t>(size), m_flag);
+				++m_map_count;
+				return reinterpret_cast<byte*>(m_scratch.get_address());
+			}
+
+			++m_tick;
+			map_window* victim = &m_windows.front();
+			for (auto& w : m_windows)
+			{
+				if (pos >= w.first && pos < w.last)
+				{
+					victim = &w;
+					break;
+				}
+				if (w.tick < victim->tick)
+					victim = &w;
+			}
+
+			if (pos < victim->first || pos >= victim->last)
+			{
+				victim->first = pos - pos % m_window_size;
+				victim->last = std::min(victim->first + m_window_size, m_capacity);
+				victim->region = map_region_(m_file, m_mode, numeric_cast<offset_t>(victim->first),
+						numeric_cast<std::size_t>(victim->last - victim->first), m_flag);
+				if (m_access_hint != ah_normal)
+					victim->region.advise(to_advice_(m_access_hint));
+				++m_map_count;
+			}
+			victim->tick = m_tick;
+
+			size = std::min(size, victim->last - pos);
+			return reinterpret_cast<byte*>(victim->region.get_address()) + (pos - victim->first);
+		}
+
+		/// unmap the windows which exceed the given size
+		void reset_windows_(long_size_t size)
+		{
+			for (auto& w : m_windows)
+			{
+				// windows end at current eof are shorter than m_window_size, drop them too.
+				if (w.last > size || w.last == m_capacity)
+				{
+					w.region = mapped_region();
+					w.first = w.last = 0;
+				}
+			}
+			m_scratch = mapped_region();
+		}
+
+		/// set the physical file size, it's also the logical size if no capacity preallocated
+		void resize_file_(long_size_t nsize)
 		{
 			fs::truncate(m_path, nsize);
 
 			long_size_t fsize = get_file_size_();
 			if (fsize != nsize)
 				AIO_THROW(archive_append_failed)(to_string(nsize));
+
+			reset_windows_(std::min(nsize, m_capacity));
+			m_capacity = nsize;
+		}
+
+		/// grow logical size to nsize. with of_preallocate, the capacity grows geometrically
+		/// and the file is trimmed to the logical size by sync() or close.
+		void extend_(long_size_t nsize)
+		{
+			AIO_PRE_CONDITION(nsize > m_file_size);
+			if ((m_flag & of_preallocate) == 0)
+			{
+				truncate(nsize);
+				return;
+			}
+
+			if (nsize > m_capacity)
+			{
+				long_size_t step = std::min(std::max(m_capacity, K_MinReserveStep), K_MaxReserveStep);
+				resize_file_(std::max(nsize, m_capacity + step));
+			}
+			m_file_size = nsize;
+		}
+
+		/// release the preallocated capacity
+		void trim_()
+		{
+			if (m_capacity > m_file_size)
+				resize_file_(m_file_size);
+		}
+
+		bi::mode_t m_mode;
+		long_size_t m_capacity;		///< physical size, greater than m_file_size if preallocated
+		file_mapping m_file;
+
+		std::size_t m_window_size;
+		std::vector<map_window> m_windows;
+		mapped_region m_scratch;
+		long_size_t m_tick;
+		long_size_t m_map_count;
+	};
+
+#ifndef WIN32
+	/// size of the internal buffer of stream_file_imp
+	const std::size_t K_StreamBufferSize = 64 * 1024;
+	/// alignment of the internal buffer and the buffered file ranges
+	const std::size_t K_StreamBufferAlignment = 4096;
+	/// alignment of offset, size and memory required by direct io
+	const std::size_t K_DirectIoAlignment = 4096;
+
+	struct stream_file_imp;
+
+	/// read view of stream_file_imp, holds a copy of the file range
+	struct stream_read_view : read_view
+	{
+		virtual range<const byte*> address() const {
+			return to_range(data);
+		}
+		buffer<byte> data;
+	};
+
+	/// write view of stream_file_imp, data is written back when destroyed.
+	/// \note the view should not outlive the file.
+	struct stream_write_view : write_view
+	{
+		stream_write_view(stream_file_imp& imp, long_size_t pos) : m_imp(imp), m_pos(pos), m_committed(false){}
+		/// commit if not yet, a failure is reported by the next sync() of the file.
+		~stream_write_view();
+
+		/// write data back to the file, throw if failed.
+		void commit();
+
+		virtual range<byte*> address() const {
+			return to_range(data);
+		}
+		mutable buffer<byte> data;
+		private:
+		stream_file_imp& m_imp;
+		long_size_t m_pos;
+		bool m_committed;
+	};
+
+	/// file_imp based on pread/pwrite and an internal aligned buffer
+	struct stream_file_imp : file_imp
+	{
+		stream_file_imp(const file_path& path, int of, bool write_mode)
+			: file_imp(path, of), m_fd(-1), m_direct_fd(-1), m_buffer(0), m_stage(0)
+			  , m_buf_first(0), m_buf_size(0), m_buf_loaded(false), m_buf_dirty_first(0), m_buf_dirty_last(0), m_view_failed(false)
+		{
+			m_fd = ::open(m_path.str().c_str(), write_mode ? O_RDWR : O_RDONLY);
+			if (m_fd < 0)
+				AIO_THROW(fs::open_failed_exception)(m_path.str());
+#ifdef O_DIRECT
+			// file system may refuse O_DIRECT(e.g. tmpfs), then all writes go through m_fd.
+			if (write_mode && (of & of_direct_io))
+				m_direct_fd = ::open(m_path.str().c_str(), O_WRONLY | O_DIRECT);
+#endif
+
+			void* p = 0;
+			if (::posix_memalign(&p, K_StreamBufferAlignment, K_StreamBufferSize) != 0)
+			{
+				::close(m_fd);
+				AIO_THROW(fs::open_failed_exception)("failed to allocate buffer for:")(m_path.str());
+			}
+			m_buffer = reinterpret_cast<byte*>(p);
+			if (m_access_hint != ah_normal)
+				advise_(m_access_hint, 0, 0);
+		}
+
+		~stream_file_imp()
+		{
+            if (m_flag & of_remove_on_close)
+            {
+				close_direct_();
+				::close(m_fd);
+				xirang::fs::remove(m_path);
+            }
+            else
+            {
+				// destructor must not throw, call sync() explicitly to get the errors
+				try { sync(); }
+				catch(...) {}
+				close_direct_();
+				::close(m_fd);
+            }
+			::free(m_buffer);
+			::free(m_stage);
+		}
+
+		virtual range<iterator> read(const range<iterator>& buf)
+		{
+			iterator itr = buf.begin();
+			while (itr != buf.end() && readable())
+			{
+				long_size_t size = std::min<long_size_t>(buf.end() - itr, m_file_size - m_pos);
+				if (in_buffer_(m_pos))
+				{
+					size = std::min(size, m_buf_first + m_buf_size - m_pos);
+					const byte* psrc = m_buffer + (m_pos - m_buf_first);
+					std::copy(psrc, psrc + size, itr);
+				}
+				else if (size >= K_StreamBufferSize)	// large read, bypass the buffer
+				{
+					flush_buffer_();
+					pread_(m_pos, itr, size);
+				}
+				else
+				{
+					load_buffer_(m_pos);
+					continue;
+				}
+				itr += size;
+				m_pos += size;
+			}
+			return range<iterator>(itr, buf.end());
+		}
+
+		virtual range<const_iterator> write(const range<const_iterator>& r)
+		{
+			if (r.empty())
+				return r;
+
+			long_size_t new_pos = m_pos + r.size();
+			mark_dirty_(m_pos, new_pos);
+			if (r.size() >= K_StreamBufferSize)	// large write, bypass the buffer
+			{
+				flush_buffer_();
+				invalidate_buffer_();
+				pwrite_(m_pos, r.begin(), r.size());
+				m_pos = new_pos;
+			}
+			else
+			{
+				for (const_iterator itr = r.begin(); itr != r.end();)
+				{
+					if (!m_buf_loaded || m_pos < m_buf_first || m_pos >= m_buf_first + K_StreamBufferSize)
+						load_buffer_(m_pos);
+
+					long_size_t offset = m_pos - m_buf_first;
+					if (offset > m_buf_size)	// gap beyond eof
+						std::fill(m_buffer + m_buf_size, m_buffer + offset, byte(0));
+
+					long_size_t size = std::min<long_size_t>(r.end() - itr, K_StreamBufferSize - offset);
+					std::copy(itr, itr + size, m_buffer + offset);
+
+					m_buf_dirty_first = m_buf_dirty_last > m_buf_dirty_first
+						? std::min(m_buf_dirty_first, std::min(offset, m_buf_size))
+						: std::min(offset, m_buf_size);
+					m_buf_dirty_last = std::max(m_buf_dirty_last, offset + size);
+					m_buf_size = std::max(m_buf_size, offset + size);
+
+					itr += size;
+					m_pos += size;
+				}
+			}
+			m_file_size = std::max(m_file_size, new_pos);
+			return range<const_iterator>(r.end(), r.end());
+		}
+
+		virtual long_size_t readv(const range<const range<iterator>*>& bufs)
+		{
+			long_size_t total = total_size_(bufs);
+			if (total < K_StreamBufferSize)	// small pieces are served by the buffer
+				return file_imp::readv(bufs);
+
+			flush_buffer_();
+			long_size_t size = m_pos < m_file_size ? std::min(total, m_file_size - m_pos) : 0;
+			std::vector<iovec> iov = make_iov_(bufs, size);
+			transfer_v_(iov, size, false, [this](const iovec* v, int count, long_size_t pos){
+					return ::preadv(m_fd, v, count, numeric_cast<off_t>(pos));
+					});
+			m_pos += size;
+			return size;
+		}
+
+		virtual long_size_t writev(const range<const range<const_iterator>*>& bufs)
+		{
+			long_size_t total = total_size_(bufs);
+			if (total < K_StreamBufferSize || m_direct_fd >= 0)	// direct io needs aligned pieces, gather by pwrite_
+				return file_imp::writev(bufs);
+
+			flush_buffer_();
+			invalidate_buffer_();
+			mark_dirty_(m_pos, m_pos + total);
+			std::vector<iovec> iov = make_iov_(bufs, total);
+			transfer_v_(iov, total, true, [this](const iovec* v, int count, long_size_t pos){
+					return ::pwritev(m_fd, v, count, numeric_cast<off_t>(pos));
+					});
+			m_pos += total;
+			m_file_size = std::max(m_file_size, m_pos);
+			return total;
+		}
+
+		virtual long_size_t truncate(long_size_t nsize)
+		{
+			flush_buffer_();
+			invalidate_buffer_();
+			if (::ftruncate(m_fd, nsize) != 0)
+				AIO_THROW(archive_append_failed)(to_string(nsize));
+
 			m_file_size = nsize;
 			if (m_pos > m_file_size)
 				m_pos = m_file_size;
-
 			return m_file_size;
 		}
-		bool writable() const { return true;}
-		void sync() 
-		{ 
-			//TODO: imp 
+
+		virtual void sync()
+		{
+			if (m_view_failed)
+			{
+				m_view_failed = false;
+				AIO_THROW(write_exception)("failed to write back a view of file:")(m_path.str());
+			}
+			flush_buffer_();
+			if (m_sync_policy == sp_none || m_dirty_first >= m_dirty_last)
+				return;
+			sync_fd_(m_fd);
+			m_dirty_first = m_dirty_last = 0;
 		}
-		unique_ptr<write_view> view_wr(ext_heap::handle h)
+
+		virtual unique_ptr<write_view> view_wr(ext_heap::handle h)
 		{
 			AIO_PRE_CONDITION(h.begin() >= 0);
 			if (m_file_size < numeric_cast<long_size_t>(h.end()))
 				truncate(h.end());
 
-			return unique_ptr<write_view>(new write_file_view(m_file, m_mode, h.begin(), numeric_cast<std::size_t>(h.size())));
+			unique_ptr<stream_write_view> ret(new stream_write_view(*this, h.begin()));
+			ret->data.resize(numeric_cast<std::size_t>(h.size()));
+			read_at(h.begin(), to_range(ret->data));
+			return std::move(ret);
 		}
 
-		unique_ptr<read_view> view_rd(ext_heap::handle h)
+		virtual unique_ptr<read_view> view_rd(ext_heap::handle h)
 		{
 			AIO_PRE_CONDITION(h.begin() >= 0);
 			AIO_PRE_CONDITION(h.empty() || numeric_cast<long_size_t>(h.begin()) < m_file_size);
@@ -176,67 +933,307 @@ namespace xirang{ namespace io{
 			if (m_file_size < numeric_cast<long_size_t>(h.end()) )
 				h = ext_heap::handle(h.begin(), m_file_size);
 
-			return unique_ptr<read_view>(new read_file_view(m_file, m_mode, h.begin(), numeric_cast<std::size_t>(h.size())));
+			unique_ptr<stream_read_view> ret(new stream_read_view);
+			ret->data.resize(numeric_cast<std::size_t>(h.size()));
+			read_at(h.begin(), to_range(ret->data));
+			return std::move(ret);
 		}
 
-		long_size_t offset() const { return m_pos; }
-		long_size_t size() const { return m_file_size;}
-		long_size_t seek(long_size_t offset) 
+		virtual native_handle_t handle()
 		{
-			m_pos = offset;
-			return m_pos;
+			flush_buffer_();
+			return m_fd;
+		}
+		virtual void advise_(access_hint hint, long_size_t first, long_size_t last)
+		{
+			fadvise_fd_(m_fd, hint, first, last);
+		}
+		virtual any getopt(int id, const any & optdata) const
+		{
+			if (id == ao_direct_io)
+				return any(m_direct_fd >= 0);
+			return file_imp::getopt(id, optdata);
+		}
+		virtual void handle_written(long_size_t first, long_size_t last)
+		{
+			invalidate_buffer_();
+			mark_dirty_(first, last);
+			m_file_size = std::max(m_file_size, last);
 		}
 
-        private:
-		bool exists_()
+		/// read from file and overlay the dirty part of buffer, the buffer is not changed.
+		virtual range<iterator> read_at(long_size_t off, const range<iterator>& buf) const
 		{
-			
-			return fs::exists(m_path);
+			if (off >= m_file_size)
+				return buf;
+
+			long_size_t size = std::min<long_size_t>(buf.size(), m_file_size - off);
+			long_size_t n = pread_fd_(m_fd, off, buf.begin(), size);
+			std::fill(buf.begin() + n, buf.begin() + size, byte(0));	// written part is still in buffer
+
+			if (m_buf_dirty_first < m_buf_dirty_last)
+			{
+				long_size_t first = std::max(off, m_buf_first + m_buf_dirty_first);
+				long_size_t last = std::min(off + size, m_buf_first + m_buf_dirty_last);
+				if (first < last)
+					std::copy(m_buffer + (first - m_buf_first), m_buffer + (last - m_buf_first), buf.begin() + (first - off));
+			}
+			return range<iterator>(buf.begin() + size, buf.end());
 		}
 
-		void create_()
+		/// write size bytes at pos, bypass the buffer and don't change the offset
+		void write_at(long_size_t pos, const byte* src, long_size_t size)
 		{
-#ifdef WIN32
-            wstring wpath = m_path.native_wstr();
-			FILE* fp = _wfopen(wpath.c_str(), L"wb");
-#else
-            FILE* fp = fopen(m_path.str().c_str(),"wb");
-#endif
-			if (fp == 0)
-				AIO_THROW(fs::create_exception)(m_path.str());
+			flush_buffer_();
+			invalidate_buffer_();
+			mark_dirty_(pos, pos + size);
+			pwrite_(pos, src, size);
+			m_file_size = std::max(m_file_size, pos + size);
+		}
+		/// report the failure at next sync()
+		void write_view_failed()
+		{
+			m_view_failed = true;
+		}
 
-			fclose(fp);
+		private:
+		bool in_buffer_(long_size_t pos) const
+		{
+			return m_buf_loaded && pos >= m_buf_first && pos < m_buf_first + m_buf_size;
 		}
 
-		long_size_t get_file_size_()
+		/// load the aligned range contains pos into buffer
+		void load_buffer_(long_size_t pos)
 		{
-			
-			auto st = fs::state(m_path);
-			if (st.state == fs::st_not_found)
-				AIO_THROW(fs::not_found_exception)(m_path.str());
-			return st.size;
+			flush_buffer_();
+			m_buf_first = pos - pos % K_StreamBufferAlignment;
+			m_buf_size = m_file_size > m_buf_first
+				? std::min<long_size_t>(K_StreamBufferSize, m_file_size - m_buf_first)
+				: 0;
+			pread_(m_buf_first, m_buffer, m_buf_size);
+			m_buf_loaded = true;
 		}
 
+		void flush_buffer_()
+		{
+			if (m_buf_dirty_first < m_buf_dirty_last)
+			{
+				if (m_direct_fd >= 0)	// widen to aligned blocks, buffer holds the file content of the whole valid range
+				{
+					m_buf_dirty_first -= m_buf_dirty_first % K_DirectIoAlignment;
+					m_buf_dirty_last = std::min(align_up_(m_buf_dirty_last), m_buf_size);
+				}
+				pwrite_(m_buf_first + m_buf_dirty_first, m_buffer + m_buf_dirty_first, m_buf_dirty_last - m_buf_dirty_first);
+				m_buf_dirty_first = m_buf_dirty_last = 0;
+			}
+		}
 
-		file_path m_path;
-		long_size_t m_pos;
-		bi::mode_t m_mode;
-		long_size_t m_file_size;
-		file_mapping m_file;
-        int m_flag;
+		void invalidate_buffer_()
+		{
+			AIO_PRE_CONDITION(m_buf_dirty_first >= m_buf_dirty_last);
+			m_buf_loaded = false;
+			m_buf_first = m_buf_size = 0;
+		}
+
+		template<typename Iterator> static long_size_t total_size_(const range<const range<Iterator>*>& bufs)
+		{
+			long_size_t total = 0;
+			for (auto& buf : bufs)
+				total += buf.size();
+			return total;
+		}
+
+		/// iovec of the leading size bytes of bufs
+		template<typename Iterator> static std::vector<iovec> make_iov_(const range<const range<Iterator>*>& bufs, long_size_t size)
+		{
+			std::vector<iovec> iov;
+			for (auto& buf : bufs)
+			{
+				if (size == 0)
+					break;
+				std::size_t len = numeric_cast<std::size_t>(std::min<long_size_t>(buf.size(), size));
+				iovec v = { const_cast<byte*>(buf.begin()), len };
+				iov.push_back(v);
+				size -= len;
+			}
+			return iov;
+		}
+
+		/// transfer size bytes at m_pos by preadv/pwritev like op, retry on EINTR and partial transfer
+		template<typename Op> void transfer_v_(std::vector<iovec>& iov, long_size_t size, bool is_write, Op op)
+		{
+			iovec* first = iov.data();
+			iovec* last = first + iov.size();
+			long_size_t pos = m_pos;
+			while (size > 0)
+			{
+				ssize_t n = op(first, int(std::min<std::ptrdiff_t>(last - first, IOV_MAX)), pos);
+				if (n < 0 && errno == EINTR)
+					continue;
+				if (n <= 0 && is_write)
+					AIO_THROW(write_exception)("failed to write file:")(m_path.str());
+				if (n <= 0)
+					AIO_THROW(read_exception)("failed to read file:")(m_path.str());
+
+				pos += n;
+				size -= n;
+				for (std::size_t left = n; left > 0;)	// skip transferred parts
+				{
+					if (left < first->iov_len)
+					{
+						first->iov_base = reinterpret_cast<byte*>(first->iov_base) + left;
+						first->iov_len -= left;
+						break;
+					}
+					left -= first->iov_len;
+					++first;
+				}
+			}
+		}
+
+		void pread_(long_size_t pos, byte* dest, long_size_t size)
+		{
+			if (pread_fd_(m_fd, pos, dest, size) != size)
+				AIO_THROW(read_exception)("unexpected end of file:")(m_path.str());
+		}
+
+		static long_size_t align_up_(long_size_t pos)
+		{
+			return (pos + K_DirectIoAlignment - 1) / K_DirectIoAlignment * K_DirectIoAlignment;
+		}
+
+		/// write size bytes at pos. in direct mode, the aligned middle part bypasses page cache,
+		/// the unaligned head and tail are written by m_fd.
+		void pwrite_(long_size_t pos, const byte* src, long_size_t size)
+		{
+			if (m_direct_fd >= 0)
+			{
+				long_size_t first = align_up_(pos);
+				long_size_t last = (pos + size) - (pos + size) % K_DirectIoAlignment;
+				if (first < last)
+				{
+					pwrite_fd_(m_fd, pos, src, first - pos);
+					if (write_direct_(first, src + (first - pos), last - first))
+					{
+						pwrite_fd_(m_fd, last, src + (last - pos), pos + size - last);
+						return;
+					}
+					pwrite_fd_(m_fd, first, src + (first - pos), pos + size - first);
+					return;
+				}
+			}
+			pwrite_fd_(m_fd, pos, src, size);
+		}
+
+		/// write aligned range by m_direct_fd, unaligned memory is copied to staging buffer first.
+		/// return false and leave direct mode if the file system rejects it.
+		bool write_direct_(long_size_t pos, const byte* src, long_size_t size)
+		{
+			AIO_PRE_CONDITION(pos % K_DirectIoAlignment == 0 && size % K_DirectIoAlignment == 0);
+			if (reinterpret_cast<std::size_t>(src) % K_DirectIoAlignment == 0)
+				return pwrite_fd_(m_direct_fd, pos, src, size, true);
+
+			if (m_stage == 0)
+			{
+				void* p = 0;
+				if (::posix_memalign(&p, K_DirectIoAlignment, K_StreamBufferSize) != 0)
+					AIO_THROW(write_exception)("failed to allocate staging buffer for:")(m_path.str());
+				m_stage = reinterpret_cast<byte*>(p);
+			}
+			while (size > 0)
+			{
+				long_size_t n = std::min<long_size_t>(size, K_StreamBufferSize);
+				std::copy(src, src + n, m_stage);
+				if (!pwrite_fd_(m_direct_fd, pos, m_stage, n, true))
+					return false;
+				src += n;
+				pos += n;
+				size -= n;
+			}
+			return true;
+		}
+
+		/// if direct is true, return false on EINVAL of first write, then direct fd is closed.
+		bool pwrite_fd_(int fd, long_size_t pos, const byte* src, long_size_t size, bool direct = false)
+		{
+			while (size > 0)
+			{
+				ssize_t n = ::pwrite(fd, src, numeric_cast<std::size_t>(size), numeric_cast<off_t>(pos));
+				if (n < 0 && errno == EINTR)
+					continue;
+				if (n < 0 && errno == EINVAL && direct)
+				{
+					close_direct_();
+					return false;
+				}
+				if (n <= 0)
+					AIO_THROW(write_exception)("failed to write file:")(m_path.str());
+				src += n;
+				pos += n;
+				size -= n;
+			}
+			return true;
+		}
+
+		void close_direct_()
+		{
+			if (m_direct_fd >= 0)
+				::close(m_direct_fd);
+			m_direct_fd = -1;
+		}
+
+		int m_fd;
+		int m_direct_fd;	///< write only fd opened with O_DIRECT, -1 if not in direct mode
+		byte* m_buffer;
+		byte* m_stage;		///< aligned staging buffer for direct writes of unaligned memory, allocated lazily
+
+		long_size_t m_buf_first;	///< file offset of buffer
+		long_size_t m_buf_size;		///< valid bytes in buffer
+		bool m_buf_loaded;
+		long_size_t m_buf_dirty_first;	///< dirty range in buffer, relative to m_buf_first
+		long_size_t m_buf_dirty_last;
+		bool m_view_failed;		///< a write_view failed to write back in its destructor
 	};
 
+	void stream_write_view::commit()
+	{
+		if (m_committed)
+			return;
+		m_committed = true;
+		m_imp.write_at(m_pos, data.begin(), data.size());
+	}
+
+	stream_write_view::~stream_write_view()
+	{
+		try { commit(); }
+		catch(...) { m_imp.write_view_failed(); }
+	}
+#endif
+
+	file_imp* create_file_imp_(const file_path& path, int of, bi::mode_t mode)
+	{
+#ifndef WIN32
+		if (of & (of_stream_io | of_direct_io))
+			return new stream_file_imp(path, of, mode == read_write);
+#endif
+		return new mapped_file_imp(path, of, mode);
+	}
+
 	/////////////////////////////////////////////////
-	file_reader::file_reader(const file_path& path)
-		: m_imp(new file_imp(path, of_open, read_only))
+	file_reader::file_reader(const file_path& path, int of)
+		: m_imp(create_file_imp_(path, (of & ~of_low_mask) | of_open, read_only))
 	{
 	}
 	file_reader::~file_reader() { check_delete(m_imp);}
+	file_reader::file_reader(file_reader&& rhs) : m_imp(rhs.m_imp) { rhs.m_imp = 0;}
 
 	range<file_reader::iterator> file_reader::read(const range<file_reader::iterator>& buf)
 	{
 		return m_imp->read(buf);
 	}
+	range<file_reader::iterator> file_reader::read_at(long_size_t off, const range<file_reader::iterator>& buf) const
+	{ return m_imp->read_at(off, buf);}
+	long_size_t file_reader::readv(const range<const range<file_reader::iterator>*>& bufs) { return m_imp->readv(bufs);}
 	bool file_reader::readable() const { return m_imp->readable();}
 	unique_ptr<read_view> file_reader::view_rd(ext_heap::handle h) const { return m_imp->view_rd(h);}
 
@@ -246,18 +1243,25 @@ namespace xirang{ namespace io{
 		if(offset > size()) offset = size();
 		return m_imp->seek(offset);
 	}
+	async_result file_reader::async_read(long_size_t off, const range<iterator>& buf) { return m_imp->async_read(off, buf);}
+	native_handle_t file_reader::handle() { return m_imp->handle();}
+	void file_reader::handle_written(long_size_t first, long_size_t last) { m_imp->handle_written(first, last);}
+	any file_reader::getopt(int id, const any & optdata) const { return m_imp->getopt(id, optdata);}
+	any file_reader::setopt(int id, const any & optdata,  const any & indata) { return m_imp->setopt(id, optdata, indata);}
 
 	/////////////////////////////////////////////////
 
 	file_writer::file_writer(const file_path& path,  int of)
-		: m_imp(new file_imp(path, of, read_write))
+		: m_imp(create_file_imp_(path, of, read_write))
 	{}
 
 	file_writer::~file_writer() 	{ check_delete(m_imp);}
+	file_writer::file_writer(file_writer&& rhs) : m_imp(rhs.m_imp) { rhs.m_imp = 0;}
 
 	range<file_writer::const_iterator> file_writer::write(
 			const range<file_writer::const_iterator>& r)
 	{ return m_imp->write(r);}
+	long_size_t file_writer::writev(const range<const range<file_writer::const_iterator>*>& bufs) { return m_imp->writev(bufs);}
 	long_size_t file_writer::truncate(long_size_t size)	{ return m_imp->truncate(size);}
 	bool file_writer::writable() const	{ return m_imp->writable(); }
 	void file_writer::sync() 	{ m_imp->sync(); }
@@ -266,24 +1270,34 @@ namespace xirang{ namespace io{
 	long_size_t file_writer::offset() const	{ return m_imp->offset(); }
 	long_size_t file_writer::size() const		{ return m_imp->size(); }
 	long_size_t file_writer::seek(long_size_t offset) { return m_imp->seek(offset); }
+	async_result file_writer::async_write(long_size_t off, const range<const_iterator>& buf) { return m_imp->async_write(off, buf);}
+	native_handle_t file_writer::handle() { return m_imp->handle();}
+	void file_writer::handle_written(long_size_t first, long_size_t last) { m_imp->handle_written(first, last);}
+	any file_writer::getopt(int id, const any & optdata) const { return m_imp->getopt(id, optdata);}
+	any file_writer::setopt(int id, const any & optdata,  const any & indata) { return m_imp->setopt(id, optdata, indata);}
 
 	/////////////////////////////////////////////////
 
 	file::file(const file_path& path, int of)
-		: m_imp(new file_imp(path, of, read_write))
+		: m_imp(create_file_imp_(path, of, read_write))
 	{}
 	file::~file()	{ check_delete(m_imp);}
+	file::file(file&& rhs) : m_imp(rhs.m_imp) { rhs.m_imp = 0;}
 
 	range<file::iterator> file::read(
 			const range<file::iterator>& buf)
 	{	return m_imp->read(buf);	}
 
+	range<file::iterator> file::read_at(long_size_t off, const range<file::iterator>& buf) const
+	{ return m_imp->read_at(off, buf);}
+	long_size_t file::readv(const range<const range<file::iterator>*>& bufs)	{ return m_imp->readv(bufs);}
 	bool file::readable() const	{ return m_imp->readable(); }
 	unique_ptr<read_view> file::view_rd(ext_heap::handle h) const { return m_imp->view_rd(h);}
 	range<file::const_iterator> file::write(
 			const range<file::const_iterator>& r)
 	{ return m_imp->write(r); }
 
+	long_size_t file::writev(const range<const range<file::const_iterator>*>& bufs)	{ return m_imp->writev(bufs);}
 	long_size_t file::truncate(long_size_t size)	{ return m_imp->truncate(size);}
 	bool file::writable() const	{ return m_imp->writable(); }
 	void file::sync() { m_imp->sync();}
@@ -292,5 +1306,11 @@ namespace xirang{ namespace io{
 	long_size_t file::offset() const	{ return m_imp->offset(); }
 	long_size_t file::size() const	{ return m_imp->size();}
 	long_size_t file::seek(long_size_t offset)	{ return m_imp->seek(offset);}
+	async_result file::async_read(long_size_t off, const range<iterator>& buf) { return m_imp->async_read(off, buf);}
+	async_result file::async_write(long_size_t off, const range<const_iterator>& buf) { return m_imp->async_write(off, buf);}
+	native_handle_t file::handle() { return m_imp->handle();}
+	void file::handle_written(long_size_t first, long_size_t last) { m_imp->handle_written(first, last);}
+	any file::getopt(int id, const any & optdata) const { return m_imp->getopt(id, optdata);}
+	any file::setopt(int id, const any & optdata,  const any & indata) { return m_imp->setopt(id, optdata, indata);}
 } }
 
@@ -5,6 +5,29 @@ namespace xirang{ namespace io{
 		return (n & ~long_size_t(size_t(-1))) == 0;
 	}
 
+	namespace {
+		template<typename Archive> long_size_t readv_(Archive& ar, const range<const range<byte*>*>& bufs){
+			long_size_t total = 0;
+			for (auto& buf : bufs){
+				auto rest = ar.read(buf);
+				total += buf.size() - rest.size();
+				if (!rest.empty())
+					break;
+			}
+			return total;
+		}
+		template<typename Archive> long_size_t writev_(Archive& ar, const range<const range<const byte*>*>& bufs){
+			long_size_t total = 0;
+			for (auto& buf : bufs){
+				auto rest = ar.write(buf);
+				total += buf.size() - rest.size();
+				if (!rest.empty())
+					break;
+			}
+			return total;
+		}
+	}
+
 	/// buffer_in
 	buffer_in::buffer_in(const buffer<byte>& buf)
 		: m_pos(0), m_data(buf)
@@ -26,6 +49,16 @@ namespace xirang{ namespace io{
 		return range<buffer_in::iterator>(ditr, buf.end());
 	}
 
+	range<buffer_in::iterator> buffer_in::read_at(long_size_t off, const range<buffer_in::iterator>& buf) const
+	{
+		if (off >= m_data.size())
+			return buf;
+		auto size = std::min<long_size_t>(buf.size(), m_data.size() - off);
+		std::copy(m_data.begin() + off, m_data.begin() + off + size, buf.begin());
+		return range<buffer_in::iterator>(buf.begin() + size, buf.end());
+	}
+	long_size_t buffer_in::readv(const range<const range<byte*>*>& bufs){ return readv_(*this, bufs);}
+
 	bool buffer_in::readable() const
 	{
 		return m_pos < m_data.size();
@@ -37,6 +70,9 @@ namespace xirang{ namespace io{
 		return buffer_rd_view(range<const byte*>(m_data.begin() + h.begin(), m_data.begin() + h.end()));
 	}
 
+	any buffer_in::getopt(int /* id */, const any & /* optdata */) const { return any();}
+	any buffer_in::setopt(int /* id */, const any & /* optdata */,  const any & /* indata */) { return any();}
+
 	long_size_t buffer_in::offset() const { return m_pos;}
 	long_size_t buffer_in::size() const { return m_data.size();}
 	long_size_t buffer_in::seek(long_size_t offset)
@@ -63,6 +99,14 @@ namespace xirang{ namespace io{
 		m_pos = sitr - m_data.begin();
 		return range<fixed_buffer_io::iterator>(ditr, buf.end());
 	}
+	range<byte*> fixed_buffer_io::read_at(long_size_t off, const range<byte*>& buf) const{
+		if (off >= m_data.size())
+			return buf;
+		auto size = std::min<long_size_t>(buf.size(), m_data.size() - off);
+		std::copy(m_data.begin() + off, m_data.begin() + off + size, buf.begin());
+		return range<byte*>(buf.begin() + size, buf.end());
+	}
+	long_size_t fixed_buffer_io::readv(const range<const range<byte*>*>& bufs){ return readv_(*this, bufs);}
 	bool fixed_buffer_io::readable() const{
 		return m_pos < m_data.size();
 	}
@@ -77,6 +121,7 @@ namespace xirang{ namespace io{
 		m_pos = ditr - m_data.begin();
 		return range<const byte*>(sitr, r.end());
 	}
+	long_size_t fixed_buffer_io::writev(const range<const range<const byte*>*>& bufs){ return writev_(*this, bufs);}
 
 	bool fixed_buffer_io::writable() const { 
 		return m_pos < m_data.size();
@@ -145,6 +190,7 @@ namespace xirang{ namespace io{
 		return range<const byte*>(r.end(), r.end());
 
 	}
+	long_size_t buffer_out::writev(const range<const range<const byte*>*>& bufs){ return writev_(*this, bufs);}
 
 	long_size_t buffer_out::truncate(long_size_t size)
 	{
@@ -199,6 +245,16 @@ namespace xirang{ namespace io{
 		return range<byte*>(ditr, buf.end());
 	}
 
+	range<byte*> buffer_io::read_at(long_size_t off, const range<byte*>& buf) const
+	{
+		if (off >= m_data.size())
+			return buf;
+		auto size = std::min<long_size_t>(buf.size(), m_data.size() - off);
+		std::copy(m_data.begin() + off, m_data.begin() + off + size, buf.begin());
+		return range<byte*>(buf.begin() + size, buf.end());
+	}
+	long_size_t buffer_io::readv(const range<const range<byte*>*>& bufs){ return readv_(*this, bufs);}
+
 	bool buffer_io::readable() const
 	{
 		return m_pos < m_data.size();
@@ -241,6 +297,7 @@ namespace xirang{ namespace io{
 		return range<const byte*>(r.end(), r.end());
 
 	}
+	long_size_t buffer_io::writev(const range<const range<const byte*>*>& bufs){ return writev_(*this, bufs);}
 
 	long_size_t buffer_io::truncate(long_size_t size)
 	{
@@ -253,6 +310,9 @@ namespace xirang{ namespace io{
 	bool buffer_io::writable() const { return true;}
 	void buffer_io::sync() {}
 
+	any buffer_io::getopt(int /* id */, const any & /* optdata */) const { return any();}
+	any buffer_io::setopt(int /* id */, const any & /* optdata */,  const any & /* indata */) { return any();}
+
 	long_size_t buffer_io::offset() const { return m_pos;}
 	long_size_t buffer_io::size() const { return m_data.size(); }
 	long_size_t buffer_io::seek(long_size_t offset) { 
@@ -288,6 +348,7 @@ namespace xirang{ namespace io{
 		m_pos += r.size();
 		return range<const byte*>(r.end(), r.end());
 	}
+	long_size_t null::writev(const range<const range<const byte*>*>& bufs){ return writev_(*this, bufs);}
 	bool null::writable() const{ return true;}
 	void null::sync() {}
 
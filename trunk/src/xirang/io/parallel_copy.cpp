@@ -0,0 +1,189 @@
+#include <xirang/io/parallel_copy.h>
+#include <xirang/deflate.h>
+
+// STD
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace xirang{ namespace io{
+	namespace {
+		/// chunks are aligned to the allocation granularity of mapped views
+		const long_size_t K_ChunkGranularity = 64 * 1024;
+		/// the checksum is computed after each block is copied, while it's still in cache
+		const std::size_t K_FuseBlockSize = 256 * 1024;
+
+		/// copy min(src.size(), dest.size()) bytes, and compute the checksum of them
+		/// \return copied bytes
+		std::size_t copy_chunk_(range<const byte*> src, range<byte*> dest, checksum_kind kind, chunk_checksum* sum){
+			std::size_t size = std::min(src.size(), dest.size());
+			uint32_t crc = zip::crc32_init();
+			sha1 sha;
+			for (std::size_t pos = 0; pos < size; pos += K_FuseBlockSize){
+				std::size_t n = std::min(K_FuseBlockSize, size - pos);
+				std::copy(src.begin() + pos, src.begin() + pos + n, dest.begin() + pos);
+
+				range<const byte*> block(dest.begin() + pos, dest.begin() + pos + n);
+				if (kind == ck_crc32)
+					crc = zip::crc32(block, crc);
+				else if (kind == ck_sha1)
+					sha.write(block);
+			}
+
+			if (sum && kind == ck_crc32)
+				sum->crc32 = crc;
+			else if (sum && kind == ck_sha1)
+				sum->sha1 = sha.get_digest();
+			return size;
+		}
+
+		/// a chunk in flight, the views are created and destroyed by current thread only
+		struct copy_slot
+		{
+			copy_slot() : sum(0), busy(false){}
+
+			iauto<read_view> rview;
+			iauto<write_view> wview;
+			chunk_checksum* sum;
+			bool busy;
+		};
+
+		/// worker threads copy the submitted slots
+		class copy_pool
+		{
+			public:
+			copy_pool(std::size_t threads, std::size_t slot_count, checksum_kind kind)
+				: m_slots(slot_count), m_kind(kind), m_stop(false)
+			{
+				for (std::size_t i = 0; i < threads; ++i)
+					m_workers.push_back(std::thread([this]{ run_(); }));
+			}
+			~copy_pool(){
+				wait_all();
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_stop = true;
+				}
+				m_cond.notify_all();
+				for (auto& i : m_workers)
+					i.join();
+			}
+
+			std::size_t slot_count() const { return m_slots.size();}
+
+			/// wait the slot idle and release its views
+			copy_slot& acquire(std::size_t index){
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_cond.wait(lock, [this, index]{ return !m_slots[index].busy; });
+				}
+				auto& slot = m_slots[index];
+				slot.rview = iauto<read_view>();
+				slot.wview = iauto<write_view>();
+				slot.sum = 0;
+				return slot;
+			}
+			void submit(std::size_t index){
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_slots[index].busy = true;
+					m_queue.push_back(index);
+				}
+				m_cond.notify_all();
+			}
+			void wait_all(){
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_cond.wait(lock, [this]{
+						for (auto& i : m_slots)
+							if (i.busy) return false;
+						return true;
+						});
+			}
+
+			private:
+			void run_(){
+				for (;;){
+					std::size_t index = 0;
+					{
+						std::unique_lock<std::mutex> lock(m_mutex);
+						m_cond.wait(lock, [this]{ return !m_queue.empty() || m_stop; });
+						if (m_queue.empty())
+							return;
+						index = m_queue.front();
+						m_queue.pop_front();
+					}
+
+					// the slot is owned by this worker until busy is cleared
+					auto& slot = m_slots[index];
+					copy_chunk_(slot.rview.get<read_view>().address(), slot.wview.get<write_view>().address(), m_kind, slot.sum);
+
+					{
+						std::lock_guard<std::mutex> lock(m_mutex);
+						slot.busy = false;
+					}
+					m_cond.notify_all();
+				}
+			}
+
+			std::vector<copy_slot> m_slots;
+			checksum_kind m_kind;
+			std::deque<std::size_t> m_queue;
+			bool m_stop;
+			std::mutex m_mutex;
+			std::condition_variable m_cond;
+			std::vector<std::thread> m_workers;
+		};
+	}
+
+	long_size_t copy_data_parallel(read_map& rd, write_map& wr, long_size_t max_size /* = ~0 */,
+			const parallel_copy_options& opts /* = parallel_copy_options() */, std::vector<chunk_checksum>* checksums /* = 0 */){
+		AIO_PRE_CONDITION(opts.chunk_size > 0);
+
+		max_size = std::min(max_size, rd.size());
+		if (checksums)
+			checksums->clear();
+		if (max_size == 0)
+			return 0;
+		if (wr.size() < max_size)
+			wr.truncate(max_size);
+
+		long_size_t chunk = (opts.chunk_size + K_ChunkGranularity - 1) / K_ChunkGranularity * K_ChunkGranularity;
+		std::size_t count = std::size_t((max_size + chunk - 1) / chunk);
+		if (checksums){
+			checksums->resize(count);
+			for (std::size_t i = 0; i < count; ++i){
+				(*checksums)[i].first = i * chunk;
+				(*checksums)[i].last = std::min(max_size, (i + 1) * chunk);
+			}
+		}
+		chunk_checksum* sums = checksums ? checksums->data() : 0;
+
+		long_size_t nsize = 0;
+		std::size_t threads = max_size < opts.min_size ? 0 : std::min<std::size_t>(opts.threads, count);
+		if (threads <= 1){
+			for (std::size_t i = 0; i < count; ++i){
+				ext_heap::handle h(i * chunk, std::min(max_size, (i + 1) * chunk));
+				auto rview = rd.view_rd(h);
+				auto wview = wr.view_wr(h);
+				nsize += copy_chunk_(rview.get<read_view>().address(), wview.get<write_view>().address()
+						, opts.checksum, sums ? sums + i : 0);
+			}
+			return nsize;
+		}
+
+		// two chunks per worker, one is copied while the other is being mapped
+		copy_pool pool(threads, threads * 2, opts.checksum);
+		for (std::size_t i = 0; i < count; ++i){
+			ext_heap::handle h(i * chunk, std::min(max_size, (i + 1) * chunk));
+			auto& slot = pool.acquire(i % pool.slot_count());
+			slot.rview = rd.view_rd(h);
+			slot.wview = wr.view_wr(h);
+			slot.sum = sums ? sums + i : 0;
+			nsize += std::min(slot.rview.get<read_view>().address().size(), slot.wview.get<write_view>().address().size());
+			pool.submit(i % pool.slot_count());
+		}
+		pool.wait_all();
+		return nsize;
+	}
+}}
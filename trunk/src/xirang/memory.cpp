@@ -11,6 +11,8 @@ namespace xirang
 	{
 		atomic::atomic_t<heap*> g_global_heap = { 0};
 		void* default_global_heap = 0;
+		/// heap of the innermost thread_heap_scope
+		thread_local heap* t_current_heap = 0;
 		static_assert(sizeof (default_global_heap) == sizeof(plain_heap), "plain_heap size is wrong");
 
         class dummy_extern_heap : public ext_heap
@@ -111,17 +113,35 @@ namespace xirang
 			return *global_heap;
 		}
 
+		AIO_COMM_API heap& get_current_heap() {
+			heap* current = t_current_heap;
+			return current ? *current : get_global_heap();
+		}
+
         AIO_COMM_API ext_heap& get_global_ext_heap() {
             return default_dummy_extern_heap;
 		}
 
+		AIO_COMM_API heap& get_thread_caching_heap()
+		{
+			// never destroyed, the dtors of static objects may free blocks to it.
+			static plain_heap* under = new plain_heap(memory::multi_thread);
+			static pool_heap* caching_heap = new pool_heap(under, memory::multi_thread);
+			return *caching_heap;
+		}
+
 		AIO_COMM_API void init_global_heap_once()
 		{
+#ifdef AIO_THREAD_CACHING_GLOBAL_HEAP
+			if (sync_get(g_global_heap) == 0)
+				atomic::sync_cas<heap*>(g_global_heap, 0, &get_thread_caching_heap());
+#else
 			if (atomic::sync_cas<heap*>(g_global_heap, 0, (heap*)&default_global_heap))
             {
                 // it's safe to constrct default_global_heap multi times.
                 new (&default_global_heap) plain_heap(memory::multi_thread);
             }
+#endif
 		}
 		AIO_COMM_API extern std::size_t max_alignment()
 		{
@@ -129,6 +149,13 @@ namespace xirang
 		}
 	}
 
+	thread_heap_scope::thread_heap_scope(heap& h) : m_saved(t_current_heap){
+		t_current_heap = &h;
+	}
+	thread_heap_scope::~thread_heap_scope(){
+		t_current_heap = m_saved;
+	}
+
 	offset_range::offset_range() : m_begin(0), m_end(0){}
 	offset_range::offset_range(long_offset_t b, long_offset_t e) : m_begin(b), m_end(e){
 		AIO_PRE_CONDITION(b <= e);
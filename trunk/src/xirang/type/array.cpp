@@ -342,8 +342,8 @@ namespace xirang { namespace type{
 		Type t = arr.type();
 		auto s = io::exchange::as_sink(wr);
 		s & arr.size();
-		for (auto i : arr)
-			t.methods().serialize(wr, i);
+		if (!arr.empty())
+			t.methods().serializeRange(wr, *arr.begin(), arr.size());
 	}
 	void deserializer<Array>::apply(io::reader& rd, CommonObject obj, heap& inner, ext_heap& outer){
 		AIO_PRE_CONDITION(obj.valid());
@@ -351,8 +351,8 @@ namespace xirang { namespace type{
 		auto s = io::exchange::as_source(rd);
 		arr.resize(io::load<size_t>(s));
 		Type t = arr.type();
-		for (auto i : arr)
-			t.methods().deserialize(rd, i, inner, outer);
+		if (!arr.empty())
+			t.methods().deserializeRange(rd, *arr.begin(), arr.size(), inner, outer);
 	}
 
 	size_t hasher<Array>::apply(ConstCommonObject obj) {
@@ -148,6 +148,27 @@ namespace xirang { namespace type{
 		}
 	}
 
+	void TypeMethods::serializeRange(io::writer& wr, ConstCommonObject first, std::size_t count){
+		if (count == 0)
+			return;
+		AIO_PRE_CONDITION(first.valid());
+
+		Type t = first.type();
+		const byte* p = reinterpret_cast<const byte*>(first.data());
+		for (std::size_t i = 0; i < count; ++i, p += t.payload())
+			serialize(wr, ConstCommonObject(t, p));
+	}
+	void TypeMethods::deserializeRange(io::reader& rd, CommonObject first, std::size_t count, heap& inner, ext_heap& outer){
+		if (count == 0)
+			return;
+		AIO_PRE_CONDITION(first.valid());
+
+		Type t = first.type();
+		byte* p = reinterpret_cast<byte*>(first.data());
+		for (std::size_t i = 0; i < count; ++i, p += t.payload())
+			deserialize(rd, CommonObject(t, p), inner, outer);
+	}
+
 	const MethodsExtension* TypeMethods::extension() const
 	{
 		return 0;
@@ -168,13 +189,14 @@ namespace xirang { namespace type{
 		AIO_PRE_CONDITION(t.valid());
 		AIO_PRE_CONDITION(&t.methods() == this );
 
-		auto s = io::exchange::as_sink(sha);
+		auto s = io::exchange::as_buffered_sink(sha);
 		AIO_PRE_CONDITION(t.valid());
 		s & t.modelName() & t.model();
 		for (auto& i : t.args())
 			s & i.name() & i.typeName() & i.type();
 		for (auto& i : t.members())
 			s & i.name() & i.typeName() & i.type();
+		s.flush();
 	}
 	static const string K_GenericType(".sys.type.generic$");
 	const string& TypeMethods::internalID() const{
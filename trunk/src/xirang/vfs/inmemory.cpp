@@ -296,16 +296,16 @@ namespace xirang{ namespace vfs{
 			void** base, unique_ptr<void>& owner, sub_file_path path, int flag){
 
 		void** ret = 0;
-		if (mask & detail::get_mask<io::writer, io::write_map>::value ){ //write open
+		if (mask & detail::get_mask<io::writer, io::write_map, io::vector_writer>::value ){ //write open
 			unique_ptr<io::buffer_io> ar(new io::buffer_io(writeOpen(path, flag)));
-			iref<io::reader, io::writer, io::random, io::ioctrl, io::read_map, io::write_map> ifile(*ar);
-			ret = copy_interface<io::reader, io::writer, io::random, io::ioctrl, io::read_map, io::write_map>::apply(mask, base, ifile, (void*)ar.get()); 
+			iref<io::reader, io::writer, io::random, io::ioctrl, io::options, io::read_map, io::write_map, io::positional_reader, io::vector_reader, io::vector_writer> ifile(*ar);
+			ret = copy_interface<io::reader, io::writer, io::random, io::ioctrl, io::options, io::read_map, io::write_map, io::positional_reader, io::vector_reader, io::vector_writer>::apply(mask, base, ifile, (void*)ar.get()); 
 			unique_ptr<void>(std::move(ar)).swap(owner);
 		}
 		else{ //read open
 			unique_ptr<io::buffer_in> ar(new io::buffer_in(readOpen(path)));
-			iref<io::reader, io::random, io::read_map> ifile(*ar);
-			ret = copy_interface<io::reader, io::random, io::read_map>::apply(mask, base, ifile, (void*)ar.get()); 
+			iref<io::reader, io::random, io::options, io::read_map, io::positional_reader, io::vector_reader> ifile(*ar);
+			ret = copy_interface<io::reader, io::random, io::options, io::read_map, io::positional_reader, io::vector_reader>::apply(mask, base, ifile, (void*)ar.get()); 
 			unique_ptr<void>(std::move(ar)).swap(owner);
 		}
 		return ret;
@@ -1,6 +1,7 @@
 #include <xirang/vfs/local.h>
 #include <xirang/type/xrbase.h>
 #include <xirang/io/file.h>
+#include <xirang/io/adaptor.h>
 #include <xirang/string_algo/utf8.h>
 #include <xirang/vfs/vfs_common.h>
 
@@ -66,8 +67,34 @@ namespace xirang{ namespace vfs{
         mutable VfsNode m_node;
 	};
 
+	namespace {
+		/// io::file with counters, members shared by several interfaces are resolved to the underlying file.
+		typedef io::decorator<io::stats_archive<io::file>
+			, io::stats_reader_p, io::stats_writer_p, io::stats_random_p, io::stats_ioctrl_p, io::stats_options_p
+			, io::stats_read_map_p, io::stats_write_map_p, io::stats_positional_reader_p, io::stats_vector_reader_p
+			, io::stats_vector_writer_p, io::stats_native_handle_p, io::stats_async_reader_p, io::stats_async_writer_p
+			> stats_file_base;
+		struct stats_file : stats_file_base
+		{
+			explicit stats_file(io::file&& ar) : stats_file_base(std::move(ar)){}
+			using io::stats_random_p<stats_file_base>::size;
+			using io::stats_writer_p<stats_file_base>::sync;
+			using io::stats_ioctrl_p<stats_file_base>::truncate;
+		};
+
+		typedef io::decorator<io::stats_archive<io::file_reader>
+			, io::stats_reader_p, io::stats_random_p, io::stats_options_p, io::stats_read_map_p
+			, io::stats_positional_reader_p, io::stats_vector_reader_p, io::stats_native_handle_p, io::stats_async_reader_p
+			> stats_file_reader_base;
+		struct stats_file_reader : stats_file_reader_base
+		{
+			explicit stats_file_reader(io::file_reader&& ar) : stats_file_reader_base(std::move(ar)){}
+			using io::stats_random_p<stats_file_reader_base>::size;
+		};
+	}
+
 	LocalFs::LocalFs(const file_path& dir)
-		: m_root(0), m_resource(dir)
+		: m_root(0), m_resource(dir), m_io_stats(false)
 	{
 	}
 	LocalFs::~LocalFs()
@@ -100,25 +127,39 @@ namespace xirang{ namespace vfs{
         return io::file(m_resource / path, flag);
 
 	}
-	io::file_reader LocalFs::readOpen(sub_file_path path){
+	io::file_reader LocalFs::readOpen(sub_file_path path, int flag){
         AIO_PRE_CONDITION(!path.is_absolute());
-        return io::file_reader(m_resource / path);
+        return io::file_reader(m_resource / path, flag);
 	}
 	void** LocalFs::do_create(unsigned long long mask,
 			void** base, unique_ptr<void>& owner, sub_file_path path, int flag){
 		using namespace io;
 
 		void** ret = 0;
-		if (mask & detail::get_mask<io::writer, io::write_map>::value ){ //write open
+		if (m_io_stats){
+			if (mask & detail::get_mask<io::writer, io::write_map, io::vector_writer, io::async_writer>::value ){
+				iauto<reader, writer, io::random, ioctrl, options, read_map, write_map, positional_reader, vector_reader, vector_writer, native_handle, async_reader, async_writer> res(stats_file(writeOpen(path, flag)));
+				ret = copy_interface<reader, writer, io::random, ioctrl, options, read_map, write_map, positional_reader, vector_reader, vector_writer, native_handle, async_reader, async_writer >::apply(mask, base, res, res.target_ptr.get());
+				unique_ptr<void>(std::move(res.target_ptr)).swap(owner);
+			}
+			else{
+				iauto<reader, io::random, options, read_map, positional_reader, vector_reader, native_handle, async_reader> res(stats_file_reader(readOpen(path, flag)));
+				ret = copy_interface<reader, io::random, options, read_map, positional_reader, vector_reader, native_handle, async_reader>::apply(mask, base, res, res.target_ptr.get());
+				unique_ptr<void>(std::move(res.target_ptr)).swap(owner);
+			}
+			return ret;
+		}
+
+		if (mask & detail::get_mask<io::writer, io::write_map, io::vector_writer, io::async_writer>::value ){ //write open
 			unique_ptr<io::file> ar(new io::file(writeOpen(path, flag)));
-			iref<reader, writer, io::random, ioctrl, read_map, write_map> ifile(*ar);
-			ret = copy_interface<reader, writer, io::random, ioctrl, read_map, write_map >::apply(mask, base, ifile, (void*)ar.get());
+			iref<reader, writer, io::random, ioctrl, options, read_map, write_map, positional_reader, vector_reader, vector_writer, native_handle, async_reader, async_writer> ifile(*ar);
+			ret = copy_interface<reader, writer, io::random, ioctrl, options, read_map, write_map, positional_reader, vector_reader, vector_writer, native_handle, async_reader, async_writer >::apply(mask, base, ifile, (void*)ar.get());
 			owner = std::move(ar);
 		}
 		else{ //read open
-			unique_ptr<io::file_reader> ar(new io::file_reader(readOpen(path)));
-			iref<reader, io::random, read_map> ifile(*ar);
-			ret = copy_interface<reader, io::random, read_map>::apply(mask, base, ifile, (void*)ar.get());
+			unique_ptr<io::file_reader> ar(new io::file_reader(readOpen(path, flag)));
+			iref<reader, io::random, options, read_map, positional_reader, vector_reader, native_handle, async_reader> ifile(*ar);
+			ret = copy_interface<reader, io::random, options, read_map, positional_reader, vector_reader, native_handle, async_reader>::apply(mask, base, ifile, (void*)ar.get());
 			owner = std::move(ar);
 		}
 		return ret;
@@ -137,7 +178,7 @@ namespace xirang{ namespace vfs{
 		}
 
 		VfsNode to_node = { to, this};
-		return xirang::vfs::copyFile(from_node, to_node);
+		return xirang::vfs::copyFile(from_node, to_node, from_node.owner_fs == this);
 	}
 
 	fs_error LocalFs::truncate(sub_file_path path, long_size_t s) {
@@ -192,6 +233,19 @@ namespace xirang{ namespace vfs{
 		return fst;
 	}
 
+	any LocalFs::getopt(int id, const any & /* optdata */) const {
+		if (id == vo_io_stats)
+			return any(m_io_stats);
+		return any();
+	}
+	any LocalFs::setopt(int id, const any & optdata,  const any & /* indata */){
+		if (id == vo_io_stats){
+			m_io_stats = any_cast<bool>(optdata);
+			return any(m_io_stats);
+		}
+		return any();
+	}
+
 	// if r == null, means unmount
 	void LocalFs::setRoot(RootFs* r) {
 		AIO_PRE_CONDITION(!mounted() || r == 0);
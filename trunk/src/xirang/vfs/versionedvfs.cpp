@@ -6,6 +6,7 @@
 #include <xirang/io/adaptor.h>
 #include <xirang/versionhelper.h>
 #include <xirang/io/s11nbasetype.h>
+#include <xirang/io/s11nfields.h>
 #include <xirang/vfs/inmemory.h>
 
 
@@ -14,6 +15,7 @@
 #include <unordered_map>
 #include <set>
 #include <map>
+#include <vector>
 #include <ctime>
 
 #include <iostream>
@@ -27,15 +29,7 @@ namespace xirang{ namespace vfs{
 		long_size_t offset;	// -1 means separated blob file.
 	};
 
-	template<typename Ar> Ar& load(Ar& ar, blob_info& tr){
-		ar & tr.flag & tr.version & tr.size & tr.offset;
-		return ar;
-	}
-
-	template<typename Ar> Ar& save(Ar& ar, const blob_info& tr){
-		ar & tr.flag & tr.version & tr.size & tr.offset;
-		return ar;
-	}
+	XIRANG_S11N_FIELDS(blob_info, flag, version, size, offset);
 
 	struct blob_info_map{
 		typedef std::unordered_map<version_type, blob_info, hash_version_type> type;
@@ -59,17 +53,7 @@ namespace xirang{ namespace vfs{
 	}
 
 	/// \note don't include version field!!!!!
-	template<typename Ar> Ar& load(Ar& ar, Submission& sub){
-		ar & sub.flag & sub.prev & sub.tree & sub.time
-			& sub.author & sub.submitter & sub.description;
-		return ar;
-	}
-
-	template<typename Ar> Ar& save(Ar& ar, const Submission& sub){
-		ar & sub.flag & sub.prev & sub.tree & sub.time
-			& sub.author & sub.submitter & sub.description;
-		return ar;
-	}
+	XIRANG_S11N_FIELDS(Submission, flag, prev, tree, time, author, submitter, description);
 
 	struct tree_blob {
 		uint32_t flag;
@@ -95,12 +79,7 @@ namespace xirang{ namespace vfs{
 		return ar;
 	}
 
-	template<typename Ar> Ar& save(Ar& ar, const FileHistoryItem& fhi){
-		return ar & fhi.submission & fhi.version;
-	}
-	template<typename Ar> Ar& load(Ar& ar, FileHistoryItem& fhi){
-		return ar & fhi.submission & fhi.version;
-	}
+	XIRANG_S11N_FIELDS(FileHistoryItem, submission, version);
 
 	typedef std::vector<FileHistoryItem> path_versions_type;
 	struct path_map_type{
@@ -316,6 +295,15 @@ namespace xirang{ namespace vfs{
 	static const sub_file_path K_head = sub_file_path(literal("#head"));
 	static const sub_file_path K_data_file = sub_file_path(literal("#content"));
 	static const sub_file_path K_remote_head = sub_file_path(literal("#remote"));
+	/// file blobs not larger than this are appended with its header in one writev call
+	static const long_size_t K_max_gather_blob = 1024 * 1024;
+
+	/// #content starts with the signature and the format version.
+	/// since version 2, integers in #blob.idx and #path.idx are varint encoded.
+	static const uint32_t K_repo_file_version = 2;
+	static const uint32_t K_repo_compact_index_version = 2;
+	static const uint32_t K_repo_file_sig = 0x4f504552; //'REPO'
+	static const std::size_t K_index_buffer_size = 64 * 1024;
 
 	static sub_file_path rest_to_end_(sub_file_path i, sub_file_path path){
 		const_range_string rest(i.str().end(), path.str().end());
@@ -445,30 +433,29 @@ namespace xirang{ namespace vfs{
 	class LocalRepositoryImp {
 		public:
 			LocalRepositoryImp(IVfs& vfs, const file_path& prefix, IVfs* host)
-				: m_underlying(vfs), m_prefix(prefix), m_host(host), m_root()
+				: m_underlying(vfs), m_prefix(prefix), m_host(host), m_root(), m_direct_ingest(false), m_compact_index(false)
 			{
-				m_data_file = m_underlying.create<io::reader, io::writer,
-							io::random, io::read_map, io::write_map>(prefix/K_data_file, io::of_open);
+				open_data_file_();
+				read_format_version_();
 
-				auto ar_head = m_underlying.create<io::reader>(prefix/K_head, io::of_open);
+				auto ar_head = m_underlying.create<io::reader>(prefix/K_head, io::of_open | io::of_access_sequential);
 				if (!ar_head) AIO_THROW(bad_repository_exception)("failed to open #head file");
 				if (ar_head.get<io::reader>().readable()){
-					auto s_head = io::exchange::as_source(ar_head.get<io::reader>());
+					auto buffered = io::decorate<io::buffered_archive, io::buffered_reader_p>(ar_head.get<io::reader>());
+					auto s_head = io::exchange::as_source(buffered);
 					s_head & m_head;
 				}
 
-				auto ar_blob_idx = m_underlying.create<io::reader>(prefix/K_blob_idx, io::of_open);
+				auto ar_blob_idx = m_underlying.create<io::reader>(prefix/K_blob_idx, io::of_open | io::of_access_sequential);
 				if (!ar_blob_idx) AIO_THROW(bad_repository_exception)("failed to open #blob.idx file");
 				if (ar_blob_idx.get<io::reader>().readable()){
-					auto s_blob_idx = io::exchange::as_source(ar_blob_idx.get<io::reader>());
-					s_blob_idx & m_blob_infos;
+					load_index_(ar_blob_idx.get<io::reader>(), m_blob_infos);
 				}
 
-				auto ar_path_map = m_underlying.create<io::reader>(prefix/K_path_idx, io::of_open);
+				auto ar_path_map = m_underlying.create<io::reader>(prefix/K_path_idx, io::of_open | io::of_access_sequential);
 				if (!ar_path_map) AIO_THROW(bad_repository_exception)("failed to open #path.idx file");
 				if (ar_path_map.get<io::reader>().readable()){
-					auto s_path_map = io::exchange::as_source(ar_path_map.get<io::reader>());
-					s_path_map & m_path_map;
+					load_index_(ar_path_map.get<io::reader>(), m_path_map);
 				}
 			}
 			void sync(){ return m_underlying.sync();}
@@ -514,12 +501,27 @@ namespace xirang{ namespace vfs{
 				}
 				return fst;
 			}
-			any getopt(int id, const any & optdata) const { return any();}
-			any setopt(int id, const any & optdata, const any & indata){ return any();}
+			any getopt(int id, const any & optdata) const {
+				if (id == ro_direct_ingest)
+					return any(m_direct_ingest);
+				return any();
+			}
+			any setopt(int id, const any & optdata, const any & indata){
+				if (id == ro_direct_ingest){
+					bool direct = any_cast<bool>(optdata);
+					if (direct != m_direct_ingest){
+						m_data_file.get<io::writer>().sync();
+						m_direct_ingest = direct;
+						open_data_file_();
+					}
+					return any(m_direct_ingest);
+				}
+				return any();
+			}
 			void** do_create(unsigned long long mask,
 						void** base, unique_ptr<void>& owner, sub_file_path path, int flag){
 				void ** ret = 0;
-				if (mask & detail::get_mask<io::reader, io::read_map>::value ){
+				if (mask & detail::get_mask<io::reader, io::read_map, io::positional_reader>::value ){
 					version_type file_version = getVersionOfPath_(path);
 					if (is_empty(file_version)) return 0;
 
@@ -533,11 +535,18 @@ namespace xirang{ namespace vfs{
 						auto adaptor = io::decorate<io::sub_archive
 							, io::sub_reader_p
 							, io::sub_read_map_p
+							, io::sub_positional_reader_p
+							, io::sub_options_p
 							>(m_data_file,
 							real_offset, real_offset + pos->second.size - 4 - 8);
 
-						iauto<io::reader, io::read_map> res (std::move(adaptor));
-						ret = copy_interface<io::reader, io::read_map>::apply(mask, base, res, res.target_ptr.get());
+						// the data file is shared, so the hint only applies to the blob range
+						auto hint = io::access_hint_of(flag);
+						if (hint != io::ah_normal)
+							adaptor.setopt(io::ao_access_hint, any(hint));
+
+						iauto<io::reader, io::read_map, io::positional_reader, io::options> res (std::move(adaptor));
+						ret = copy_interface<io::reader, io::read_map, io::positional_reader, io::options>::apply(mask, base, res, res.target_ptr.get());
 						unique_ptr<void>(std::move(res.target_ptr)).swap(owner);
 						return ret;
 					}else { // for big file, put under folder '#data'
@@ -612,7 +621,7 @@ namespace xirang{ namespace vfs{
 				}
 
 				Context ctx;
-				ctx.idx_file = m_underlying.create<io::writer, io::random>(m_prefix/K_blob_idx, io::of_create_or_open);
+				ctx.idx_file = m_underlying.create<io::writer, io::random>(m_prefix/K_blob_idx, io::of_create_or_open | io::of_sync_durable);
 				if (!ctx.idx_file) AIO_THROW(bad_repository_exception)("failed to open #blob.idx file");
 				auto & seek = ctx.idx_file.get<io::random>();
 				seek.seek(seek.size());
@@ -628,13 +637,12 @@ namespace xirang{ namespace vfs{
 				sub.version = version_of_object(sub);	// Submission serialier ignore version field
 				append_submission_blob_(sub, ctx);
 
-				auto tree_map_file = m_underlying.create<io::writer, io::random>(m_prefix/K_path_idx, io::of_create_or_open);
+				auto tree_map_file = m_underlying.create<io::writer, io::random>(m_prefix/K_path_idx, io::of_create_or_open | io::of_sync_durable);
 				if (!tree_map_file) AIO_THROW(bad_repository_exception)("failed to open #path.idx file");
 				auto & seek2 = tree_map_file.get<io::random>();
 				seek2.seek(seek2.size());
 
 				path_map_type new_path_map;
-				auto sink = io::exchange::as_sink(tree_map_file.get<io::writer>());
 				for (auto& i : ctx.path_versions){
 					auto & v = m_path_map.items[i.first];
 					//just record changes
@@ -645,7 +653,7 @@ namespace xirang{ namespace vfs{
 					}
 				}
 				if (!new_path_map.items.empty())
-					sink & new_path_map;
+					save_index_(tree_map_file.get<io::writer>(), new_path_map);
 
 				return sub;
 			}
@@ -701,6 +709,52 @@ namespace xirang{ namespace vfs{
 				return save_tree_blob_(path_in_repo, new_tree, ctx);
 			}
 
+			/// read the header of #content file, throw on a bad signature or a version newer than K_repo_file_version.
+			void read_format_version_(){
+				m_data_file.get<io::random>().seek(0);
+				auto source = io::exchange::as_source(m_data_file.get<io::reader>());
+				uint32_t sig = 0, version = 0;
+				source & sig & version;
+				if (sig != K_repo_file_sig) AIO_THROW(bad_repository_exception)("bad signature of #content file");
+				if (version > K_repo_file_version) AIO_THROW(bad_repository_exception)("unsupported repository format version");
+				m_compact_index = version >= K_repo_compact_index_version;
+			}
+			template<typename T> void save_index_(io::writer& wr, const T& value){
+				if (m_compact_index){
+					auto sink = io::exchange::as_buffered_sink(wr, io::exchange::default_stage_size, io::exchange::varint_encoding());
+					sink & value;
+					sink.flush();
+				}
+				else{
+					auto sink = io::exchange::as_buffered_sink(wr);
+					sink & value;
+					sink.flush();
+				}
+			}
+			template<typename T> void load_index_(io::reader& rd, T& value){
+				if (m_compact_index){
+					auto source = io::exchange::as_buffered_source(rd, K_index_buffer_size, io::exchange::varint_encoding());
+					source & value;
+				}
+				else{
+					auto source = io::exchange::as_buffered_source(rd, K_index_buffer_size);
+					source & value;
+				}
+			}
+			/// (re)open the blob data file, in direct ingest mode written blobs bypass the page cache.
+			void open_data_file_(){
+				int flag = io::of_open | io::of_preallocate | io::of_sync_durable;
+				if (m_direct_ingest) flag |= io::of_direct_io;
+				try{
+					m_data_file = m_underlying.create<io::reader, io::writer,
+								io::random, io::options, io::read_map, io::write_map, io::positional_reader, io::vector_writer>(m_prefix/K_data_file, flag);
+				}
+				catch(unsupport_interface&){
+					AIO_THROW(bad_repository_exception)("#content file must support options, positional_reader and vector_writer");
+				}
+				if (!m_data_file) AIO_THROW(bad_repository_exception)("failed to open #content file");
+			}
+
 			version_type save_tree_blob_(const file_path& path, const tree_blob& tree, Context& ctx){
 				version_type ret = version_of_object(tree);
 				if (m_blob_infos.items.count(ret) !=  0)
@@ -712,8 +766,9 @@ namespace xirang{ namespace vfs{
 				auto offset = seek.size();
 				seek.seek(offset);
 
-				auto sink = io::exchange::as_sink(m_data_file.get<io::writer>());
+				auto sink = io::exchange::as_buffered_sink(m_data_file.get<io::writer>());
 				sink & tree;
+				sink.flush();
 
 				save_blob_idx_(bt_tree, ret, seek.size() - offset, offset, ctx);
 
@@ -722,7 +777,7 @@ namespace xirang{ namespace vfs{
 			}
 
 			version_type add_file_to_repo_(IWorkspace& wk, const file_path& path, Context& ctx) {
-				auto src = wk.create<io::read_map>(path, io::of_open);
+				auto src = wk.create<io::read_map>(path, io::of_open | io::of_access_sequential);
 				if (!src) AIO_THROW(fs::open_failed_exception)("failed to open file in workdir");
 				auto& src_map = src.get<io::read_map>();
 
@@ -735,9 +790,25 @@ namespace xirang{ namespace vfs{
 				auto& seek = m_data_file.get<io::random>();
 				long_size_t offset = seek.size();
 				seek.seek(offset);
-				auto sink = io::exchange::as_sink(m_data_file.get<io::writer>());
+				byte header[4 + 8];	// 4: flag size, 8: real file size
+				io::fixed_buffer_io header_buf(make_range(header, header + sizeof(header)));
+				auto sink = io::exchange::as_sink(header_buf);
 				sink & uint32_t(bt_file) & uint64_t(src_map.size());
-				copy_data(src_map, m_data_file.get<io::writer>());
+				range<const byte*> header_range(make_range(header, header + sizeof(header)));
+
+				if (src_map.size() <= K_max_gather_blob){
+					iauto<io::read_view> view;
+					range<const byte*> bufs[2] = { header_range };
+					if (src_map.size() > 0){
+						view = src_map.view_rd(ext_heap::handle(0, src_map.size()));
+						bufs[1] = view.get<io::read_view>().address();
+					}
+					m_data_file.get<io::vector_writer>().writev(make_range(bufs, bufs + 2));
+				}
+				else{
+					m_data_file.get<io::writer>().write(header_range);
+					copy_data(src_map, m_data_file.get<io::writer>());
+				}
 
 				save_blob_idx_(bt_file, ret, seek.size() - offset, offset, ctx);
 
@@ -757,12 +828,17 @@ namespace xirang{ namespace vfs{
 				auto& seek = m_data_file.get<io::random>();
 				auto offset = seek.size();
 				seek.seek(offset);
-				auto sink = io::exchange::as_sink(m_data_file.get<io::writer>());
+				auto sink = io::exchange::as_buffered_sink(m_data_file.get<io::writer>());
 				sink & sub;
+				sink.flush();
 
 				save_blob_idx_(bt_submission, sub.version, seek.size() - offset, offset, ctx);
 
-				auto ar_head = m_underlying.create<io::writer, io::random>(m_prefix/K_head, io::of_create_or_open);
+				// one durable flush per commit, blobs must reach the storage before #head refers them.
+				m_data_file.get<io::writer>().sync();
+				ctx.idx_file.get<io::writer>().sync();
+
+				auto ar_head = m_underlying.create<io::writer, io::random>(m_prefix/K_head, io::of_create_or_open | io::of_sync_durable);
 				if (!ar_head) AIO_THROW(bad_repository_exception)("failed to create #head file");
 
 				auto sink2 = io::exchange::as_sink(ar_head.get<io::writer>());
@@ -781,13 +857,43 @@ namespace xirang{ namespace vfs{
 
 					auto& seek = m_data_file.get<io::random>();
 					seek.seek(pos->second.offset);
-					auto source = io::exchange::as_source(m_data_file.get<io::reader>());
+					auto source = io::exchange::as_buffered_source(m_data_file.get<io::reader>());
 					return load<T>(source);
 				}
+			/// read the blob into buf by positional_reader, it doesn't map a view or move the file offset.
+			/// \return the data in buf, empty if ver is not a blob of given type
+			range<const byte*> read_blob_(const version_type& ver, uint32_t type, std::vector<byte>& buf) const{
+				auto pos = m_blob_infos.items.find(ver);
+				if (pos == m_blob_infos.items.end() || pos->second.flag != type)
+					return range<const byte*>();
+
+				buf.resize(std::size_t(pos->second.size));	// keep the capacity for next blob
+				range<byte*> dest(buf.data(), buf.data() + buf.size());
+				auto rest = m_data_file.get<io::positional_reader>().read_at(pos->second.offset, dest);
+				return range<const byte*>(buf.data(), rest.begin());
+			}
+			/// look up name in the tree blob without loading it into a tree_blob, names are compared in buf
+			/// instead of being copied into strings.
+			/// \param buf reused by the lookups of one path
+			/// \return the version of name, or empty version if not found
+			version_type find_in_tree_(const version_type& tree_id, const_range_string name, std::vector<byte>& buf) const{
+				io::exchange::memory_source data(read_blob_(tree_id, bt_tree, buf));
+				if (!data.readable())
+					return version_type();
+
+				auto source = io::exchange::as_source(data);
+				if (io::load<uint32_t>(source) != bt_tree)
+					return version_type();
+				for (size_t n = load_size_t(source); n > 0; --n){
+					auto version = io::load<version_type>(source);
+					if (io::load<const_range_string>(source) == name)
+						return version;
+				}
+				return version_type();
+			}
 			void save_blob_idx_(uint32_t flag, const version_type& ver, uint64_t size, long_size_t offset, Context& ctx){
 				blob_info binfo = {flag, ver, size, offset};
-				auto sink = io::exchange::as_sink(ctx.idx_file.get<io::writer>());
-				sink & binfo;
+				save_index_(ctx.idx_file.get<io::writer>(), binfo);
 				m_blob_infos.items.insert(std::make_pair(binfo.version, binfo));
 			}
 
@@ -798,25 +904,22 @@ namespace xirang{ namespace vfs{
 				}
 				return getFileVersion(m_head, p);
 			}
+			/// one find_in_tree_ per path component, all of them share one buffer.
 			version_type getFileVersionFromTree_(const version_type& tree_id, const file_path& p) const{
-				auto tree= get_blob_<tree_blob>(tree_id, bt_tree);
-				if (tree.flag != bt_tree) return version_type();
-
+				version_type tree = tree_id;
+				std::vector<byte> buf;
 				for (auto i(p.begin()), last(p.end());  i != last;){
-					auto idir = tree.items.find(i->str());
-					if (idir == tree.items.end())
+					auto version = find_in_tree_(tree, i->str(), buf);
+					if (is_empty(version))
 					  return version_type();
 
-					auto & version = idir->second;
 					if (++i == last) return version;
 
 					auto ipos = m_blob_infos.items.find(version);
 					if (ipos == m_blob_infos.items.end()) return version_type();
 
-					if (ipos->second.flag == bt_tree){
-						tree = get_blob_<tree_blob>(version, bt_tree);
-						if (tree.flag != bt_tree) return version_type();
-					}
+					if (ipos->second.flag == bt_tree)
+						tree = version;
 				}
 				AIO_POST_CONDITION(false && "Logic wrong, should not reach here.");
 				return version_type();
@@ -829,7 +932,9 @@ namespace xirang{ namespace vfs{
 			blob_info_map m_blob_infos;
 			path_map_type m_path_map;
 			version_type m_head;
-			iauto<io::reader, io::writer, io::random, io::read_map, io::write_map> m_data_file;
+			iauto<io::reader, io::writer, io::random, io::options, io::read_map, io::write_map, io::positional_reader, io::vector_writer> m_data_file;
+			bool m_direct_ingest;
+			bool m_compact_index;
 	};
 	LocalRepository::LocalRepository(IVfs& vfs, const file_path& prefix)
 		: m_imp(new LocalRepositoryImp(vfs, prefix, this))
@@ -983,9 +1088,6 @@ namespace xirang{ namespace vfs{
 		return true;
 	}
 
-	static const uint32_t K_repo_file_version = 1;
-	static const uint32_t K_repo_file_sig = 0x4f504552; //'REPO'
-
 	fs_error initRepository(IVfs& vfs, sub_file_path dir){
 		if (vfs.state(dir / K_data_file).state != fs::st_not_found){
 			return fs::er_exist;
@@ -23,14 +23,25 @@ namespace xirang{ namespace vfs{
 		return fs::er_ok;
 	}
 
-	fs_error copyFile(const VfsNode& from, const VfsNode& to)
+	fs_error copyFile(const VfsNode& from, const VfsNode& to, bool native /* = false */)
 	{
 		using io::reader;
 		using io::writer;
 		using io::sequence;
 
 		try{
-			auto src = from.owner_fs->create<reader, sequence>(from.path, io::of_open);
+			if (native){
+				auto src = from.owner_fs->create<reader, io::random, io::native_handle>(from.path, io::of_open | io::of_access_sequential);
+				auto dest = to.owner_fs->create<writer, io::random, io::native_handle>(to.path, io::of_create_or_open);
+
+				long_size_t copied_size = copy_data(iref<reader, io::random, io::native_handle>(src)
+						, iref<writer, io::random, io::native_handle>(dest));
+				if (copied_size != src.get<io::random>().size())
+					return fs::er_system_error;
+				return fs::er_ok;
+			}
+
+			auto src = from.owner_fs->create<reader, sequence>(from.path, io::of_open | io::of_access_sequential);
 			auto dest = to.owner_fs->create<writer>(to.path, io::of_create_or_open);
 
 			long_size_t copied_size = copy_data(src.get<reader>(), dest.get<writer>());
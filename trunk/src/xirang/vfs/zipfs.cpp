@@ -167,8 +167,12 @@ namespace xirang{ namespace vfs{
 				auto fin = zip::open_raw(info.header);
 				auto fout = temp_file<io::write_map>(*m_cache, sub_file_path(), sub_file_path()
 						, io::of_remove_on_close, &info.cache_name);
-				auto s = io::copy_data(fin.get<io::read_map>(), fout.get<io::write_map>());
-				if (s != fin.get<io::read_map>().size()){
+				long_size_t s = 0;
+				if (info.header.method == zip::cm_deflate)
+					s = zip::inflate(fin.get<io::read_map>(), fout.get<io::write_map>()).out_size;
+				else
+					s = io::copy_data(fin.get<io::read_map>(), fout.get<io::write_map>());
+				if (s != info.header.uncompressed_size){
 					info.cache_name = file_path();
 					return fs::er_system_error;
 				}
@@ -196,7 +200,7 @@ namespace xirang{ namespace vfs{
 						continue;
 					}
 					if (info.is_dirty){
-						auto src = m_cache->create<io::read_map>(info.cache_name, io::of_open);
+						auto src = m_cache->create<io::read_map>(info.cache_name, io::of_open | io::of_access_sequential);
 						zip_writer.append(src.get<io::read_map>(), i.first);
 					}
 					else{
@@ -285,7 +289,7 @@ namespace xirang{ namespace vfs{
 			void** do_create(unsigned long long mask,
 					void** base, unique_ptr<void>& owner, sub_file_path path, int flag){
 				AIO_PRE_CONDITION(!path.is_absolute());
-				bool need_write = (mask & detail::get_mask<io::writer, io::write_map>::value ) != 0;
+				bool need_write = (mask & detail::get_mask<io::writer, io::write_map, io::vector_writer, io::async_writer>::value ) != 0;
 				if ((is_readonly_()  && need_write) ||path.empty())
 					AIO_THROW(fs::permission_denied_exception);
 
@@ -316,7 +320,7 @@ namespace xirang{ namespace vfs{
 						AIO_THROW(fs::system_error_exception);
 				}
 
-				if (mask & detail::get_mask<io::writer, io::write_map>::value )
+				if (mask & detail::get_mask<io::writer, io::write_map, io::vector_writer, io::async_writer>::value )
 					pos->second.is_dirty = true;
 
 				if (m_cache)
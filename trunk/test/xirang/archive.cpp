@@ -5,11 +5,32 @@ $COMMON_HEAD_COMMENTS_CONTEXT$
 #include "precompile.h"
 #include <xirang/io/memory.h>
 #include <xirang/io/s11n.h>
+#include <xirang/io/s11nfields.h>
+#include <xirang/io/versiontype.h>
+#include <xirang/varint.h>
 #include "./iarchive.h"
 
 BOOST_AUTO_TEST_SUITE(archive_suite)
 using namespace xirang;
 
+struct fixed_item { uint32_t a; uint16_t b; uint16_t c; int64_t d; };
+XIRANG_S11N_FIELDS(fixed_item, a, b, c, d);
+struct padded_item { uint16_t a; uint32_t b; };
+XIRANG_S11N_FIELDS(padded_item, a, b);
+struct reordered_item { uint32_t a; uint32_t b; };
+XIRANG_S11N_FIELDS(reordered_item, b, a);
+struct nested_item { fixed_item f; version_type v; uint32_t tail[3]; };
+XIRANG_S11N_FIELDS(nested_item, f, v, tail);
+struct mixed_item { uint32_t a; string s; bool flag; };
+XIRANG_S11N_FIELDS(mixed_item, a, s, flag);
+
+static_assert(io::s11n::is_fixed_field<fixed_item>::value, "fixed layout");
+static_assert(!io::s11n::is_fixed_field<padded_item>::value, "padding");
+static_assert(!io::s11n::is_fixed_field<reordered_item>::value, "not in order");
+static_assert(io::s11n::is_fixed_field<version_type>::value, "nested fixed layout");
+static_assert(io::s11n::is_fixed_field<nested_item>::value, "nested fixed layout");
+static_assert(!io::s11n::is_fixed_field<mixed_item>::value, "variable size");
+
 BOOST_AUTO_TEST_CASE(buffer_in_case)
 {
 	xirang::buffer<xirang::byte> buf(128, byte('X'));
@@ -19,6 +40,7 @@ BOOST_AUTO_TEST_CASE(buffer_in_case)
 
 	tester.check_reader(ar);
 	tester.check_random(ar);
+	tester.check_positional_reader(ar);
 }
 
 BOOST_AUTO_TEST_CASE(buffer_out_case)
@@ -42,6 +64,8 @@ BOOST_AUTO_TEST_CASE(buffer_io_case)
 	tester.check_reader(ar);
 	tester.check_writer(ar);
 	tester.check_random(ar);
+	tester.check_positional_reader(ar);
+	tester.check_vector_io(ar);
 }
 
 BOOST_AUTO_TEST_CASE(mem_read_archive_case)
@@ -73,6 +97,7 @@ BOOST_AUTO_TEST_CASE(mem_read_write_archive_case)
 	ar.seek(0);
 	tester.check_reader(ar);
 	tester.check_random(ar);
+	tester.check_positional_reader(ar);
 }
 
 
@@ -105,4 +130,259 @@ BOOST_AUTO_TEST_CASE(mem_archive_case)
 
 }
 
+BOOST_AUTO_TEST_CASE(exchange_buffered_case)
+{
+	io::mem_archive ar;
+	iref<io::reader, io::writer> iar(ar);
+	io::writer& wr = iar.get<io::writer>();
+	io::reader& rd = iar.get<io::reader>();
+
+	{
+		auto sink = io::exchange::as_buffered_sink(wr, 16);
+		for (uint32_t i = 0; i < 10; ++i)
+			sink & i;
+		BOOST_CHECK(ar.size() == 8 * sizeof(uint32_t));	// the tail is pending
+		sink.flush();
+		BOOST_CHECK(ar.size() == 10 * sizeof(uint32_t));
+
+		sink & string("hello");
+		BOOST_CHECK(ar.size() == 10 * sizeof(uint32_t));
+
+		auto sink2 = std::move(sink);	// pending data is moved, not written twice
+		sink2 & uint64_t(42);
+	}
+	BOOST_CHECK(ar.size() == 10 * sizeof(uint32_t) + sizeof(uint32_t) + 5 + sizeof(uint64_t));
+
+	ar.seek(0);
+	auto source = io::exchange::as_buffered_source(rd, 16);
+	for (uint32_t i = 0; i < 10; ++i)
+		BOOST_CHECK(io::load<uint32_t>(source) == i);
+	BOOST_CHECK(io::load<string>(source) == string("hello"));
+	BOOST_CHECK(io::load<uint64_t>(source) == 42);
+	BOOST_CHECK(!source.readable());
+	BOOST_CHECK_THROW(io::load<uint32_t>(source), io::read_exception);
+
+	// same bytes as the unbuffered serializer
+	io::mem_archive ar2;
+	auto sink = io::exchange::as_sink(ar2);
+	for (uint32_t i = 0; i < 10; ++i)
+		sink & i;
+	sink & string("hello") & uint64_t(42);
+	BOOST_CHECK(ar2.data() == ar.data());
+}
+
+BOOST_AUTO_TEST_CASE(exchange_bulk_case)
+{
+	xirang::buffer<int32_t> ints;
+	for (int32_t i = 0; i < 1000; ++i)
+		ints.push_back(i * 7919 - 5000);
+	xirang::buffer<double> doubles;
+	doubles.push_back(0.5);
+	doubles.push_back(-1e300);
+	xirang::buffer<bool> bools;
+	bools.push_back(true);
+	bools.push_back(false);
+	wstring wstr(L"exchange");
+
+	io::mem_archive bulk;
+	auto sink = io::exchange::as_sink(bulk);
+	sink & ints & doubles & bools & wstr;
+	BOOST_CHECK(bulk.size() == 4 + 1000 * 4 + 4 + 2 * 8 + 4 + 2 + 4 + 8 * 4);
+
+	// same bytes as element by element
+	io::mem_archive single;
+	auto sink2 = io::exchange::as_sink(single);
+	sink2 & uint32_t(ints.size());
+	for (auto i : ints)
+		sink2 & i;
+	BOOST_CHECK(single.data() == make_range(bulk.data().begin(), bulk.data().begin() + single.size()));
+
+	bulk.seek(0);
+	auto source = io::exchange::as_source(bulk);
+	BOOST_CHECK(io::load<xirang::buffer<int32_t> >(source) == ints);
+	BOOST_CHECK(io::load<xirang::buffer<double> >(source) == doubles);
+	BOOST_CHECK(io::load<xirang::buffer<bool> >(source) == bools);
+	BOOST_CHECK(io::load<wstring>(source) == wstr);
+
+	// load_range still checks the range of non-bulk types
+	io::mem_archive bad;
+	auto sink3 = io::exchange::as_sink(bad);
+	sink3 & int8_t(2);
+	bad.seek(0);
+	auto source3 = io::exchange::as_source(bad);
+	bool b = false;
+	BOOST_CHECK_THROW(io::exchange::load_range(source3, make_range(&b, &b + 1)), io::exchange::bad_exchange_cast);
+}
+
+BOOST_AUTO_TEST_CASE(varint_case)
+{
+	const uint64_t values[] = { 0, 1, 127, 128, 300, 16383, 16384, (uint64_t(1) << 32) - 1,
+		uint64_t(1) << 49, (uint64_t(1) << 56) - 1, uint64_t(1) << 56, (uint64_t(1) << 63) - 1, ~uint64_t(0) };
+	for (auto v : values){
+		byte buf[varint::max_size + 8];
+		byte* last = varint::encode(v, buf);
+		uint64_t d = 0;
+		BOOST_CHECK(varint::decode(buf, last, d) == last);	// exact size
+		BOOST_CHECK(d == v);
+		d = 0;
+		BOOST_CHECK(varint::decode(buf, buf + sizeof(buf), d) == last);	// with trailing bytes
+		BOOST_CHECK(d == v);
+		if (last - buf > 1)
+			BOOST_CHECK(varint::decode(buf, last - 1, d) == 0);	// truncated
+	}
+	BOOST_CHECK(varint::zigzag_encode(0) == 0);
+	BOOST_CHECK(varint::zigzag_encode(-1) == 1);
+	BOOST_CHECK(varint::zigzag_encode(1) == 2);
+	BOOST_CHECK(varint::zigzag_decode(varint::zigzag_encode(std::numeric_limits<int64_t>::min())) == std::numeric_limits<int64_t>::min());
+
+	// 11 bytes is overflow
+	byte overlong[11];
+	std::fill(overlong, overlong + 10, byte(0x80));
+	overlong[10] = byte(0);
+	uint64_t d = 0;
+	BOOST_CHECK(varint::decode(overlong, overlong + 11, d) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(exchange_varint_case)
+{
+	io::mem_archive ar;
+	{
+		auto sink = io::exchange::as_sink(ar, io::exchange::varint_encoding());
+		sink & uint32_t(0) & uint32_t(127) & uint32_t(128) & int32_t(-1)
+			& std::numeric_limits<int64_t>::min() & ~uint64_t(0) & 0.5 & string("hello") & int8_t(-3);
+	}
+	BOOST_CHECK(ar.size() == 1 + 1 + 2 + 1 + 10 + 10 + 8 + 1 + 5 + 1);
+
+	// byte by byte decoding
+	ar.seek(0);
+	auto source = io::exchange::as_source(ar, io::exchange::varint_encoding());
+	BOOST_CHECK(io::load<uint32_t>(source) == 0);
+	BOOST_CHECK(io::load<uint32_t>(source) == 127);
+	BOOST_CHECK(io::load<uint32_t>(source) == 128);
+	BOOST_CHECK(io::load<int32_t>(source) == -1);
+	BOOST_CHECK(io::load<int64_t>(source) == std::numeric_limits<int64_t>::min());
+	BOOST_CHECK(io::load<uint64_t>(source) == ~uint64_t(0));
+	BOOST_CHECK(io::load<double>(source) == 0.5);
+	BOOST_CHECK(io::load<string>(source) == string("hello"));
+	BOOST_CHECK(io::load<int8_t>(source) == -3);
+	BOOST_CHECK_THROW(io::load<uint32_t>(source), io::read_exception);
+
+	// decoding in the read-ahead buffer
+	ar.seek(0);
+	auto buffered = io::exchange::as_buffered_source(ar, 16, io::exchange::varint_encoding());
+	BOOST_CHECK(io::load<uint32_t>(buffered) == 0);
+	BOOST_CHECK(io::load<uint32_t>(buffered) == 127);
+	BOOST_CHECK(io::load<uint32_t>(buffered) == 128);
+	BOOST_CHECK(io::load<int32_t>(buffered) == -1);
+	BOOST_CHECK(io::load<int64_t>(buffered) == std::numeric_limits<int64_t>::min());
+	BOOST_CHECK_THROW(io::load<uint32_t>(buffered), io::exchange::bad_exchange_cast);	// uint64 max
+	BOOST_CHECK(io::load<double>(buffered) == 0.5);
+	BOOST_CHECK(io::load<string>(buffered) == string("hello"));
+	BOOST_CHECK(io::load<int8_t>(buffered) == -3);
+	BOOST_CHECK_THROW(io::load<uint32_t>(buffered), io::read_exception);
+
+	// ranges of integers are encoded one by one
+	xirang::buffer<int32_t> ints;
+	for (int32_t i = -50; i < 50; ++i)
+		ints.push_back(i);
+	io::mem_archive ar2;
+	auto sink = io::exchange::as_buffered_sink(ar2, 64, io::exchange::varint_encoding());
+	sink & ints;
+	sink.flush();
+	BOOST_CHECK(ar2.size() == 1 + 100);
+	ar2.seek(0);
+	auto source2 = io::exchange::as_buffered_source(ar2, 64, io::exchange::varint_encoding());
+	BOOST_CHECK(io::load<xirang::buffer<int32_t> >(source2) == ints);
+}
+
+BOOST_AUTO_TEST_CASE(exchange_memory_source_case)
+{
+	io::mem_archive ar;
+	xirang::buffer<byte> bytes(5, byte('B'));
+	{
+		auto sink = io::exchange::as_sink(ar);
+		sink & uint32_t(42) & string("hello") & bytes & string();
+	}
+
+	// strings and bytes point into the memory
+	auto data = make_range(static_cast<const byte*>(ar.data().begin()), static_cast<const byte*>(ar.data().end()));
+	io::exchange::memory_source mem(data);
+	auto source = io::exchange::as_source(mem);
+	BOOST_CHECK(io::load<uint32_t>(source) == 42);
+	auto str = io::load<const_range_string>(source);
+	BOOST_CHECK(str == literal("hello"));
+	BOOST_CHECK((const byte*)str.begin() > data.begin() && (const byte*)str.end() < data.end());
+	auto rbytes = io::load<range<const byte*> >(source);
+	BOOST_CHECK(rbytes.size() == 5 && std::equal(rbytes.begin(), rbytes.end(), bytes.begin()));
+	BOOST_CHECK(rbytes.begin() >= data.begin() && rbytes.end() <= data.end());
+	BOOST_CHECK(io::load<const_range_string>(source).empty());
+	BOOST_CHECK(!source.readable());
+	BOOST_CHECK_THROW(io::load<const_range_string>(source), io::read_exception);
+
+	// the source keeps the view
+	iref<io::read_map> imap(ar);
+	io::exchange::memory_source view_mem(imap.get<io::read_map>().view_rd(ext_heap::handle(0, ar.size())));
+	auto source2 = io::exchange::as_source(view_mem, io::exchange::fixed_encoding());
+	BOOST_CHECK(io::load<uint32_t>(source2) == 42);
+	BOOST_CHECK(io::load<const_range_string>(source2) == literal("hello"));
+
+	// varints are decoded in place
+	io::mem_archive ar2;
+	auto sink2 = io::exchange::as_sink(ar2, io::exchange::varint_encoding());
+	sink2 & uint64_t(300) & string("v");
+	io::exchange::memory_source mem2(make_range(static_cast<const byte*>(ar2.data().begin()), static_cast<const byte*>(ar2.data().end())));
+	auto source3 = io::exchange::as_source(mem2, io::exchange::varint_encoding());
+	BOOST_CHECK(io::load<uint64_t>(source3) == 300);
+	BOOST_CHECK(io::load<const_range_string>(source3) == literal("v"));
+}
+
+BOOST_AUTO_TEST_CASE(s11n_fields_case)
+{
+	fixed_item fi = { 1, 2, 3, -4 };
+	padded_item pi = { 5, 6 };
+	reordered_item ri = { 7, 8 };
+	nested_item ni = { fi, version_type(), { 9, 10, 11 } };
+	ni.v.conflict_id = 12;
+	mixed_item mi = { 13, string("mixed"), true };
+
+	io::mem_archive ar;
+	auto sink = io::exchange::as_sink(ar);
+	sink & fi & pi & ri & ni & mi;
+
+	// same bytes as field by field
+	io::mem_archive ar2;
+	auto sink2 = io::exchange::as_sink(ar2);
+	sink2 & fi.a & fi.b & fi.c & fi.d & pi.a & pi.b & ri.b & ri.a;
+	sink2 & fi.a & fi.b & fi.c & fi.d & ni.v.protocol_version & ni.v.algorithm;
+	for (auto i : ni.v.id.v)
+		sink2 & i;
+	sink2 & ni.v.conflict_id & ni.tail[0] & ni.tail[1] & ni.tail[2];
+	sink2 & mi.a & mi.s & mi.flag;
+	BOOST_CHECK(ar.data() == ar2.data());
+
+	ar.seek(0);
+	auto source = io::exchange::as_source(ar);
+	auto lfi = io::load<fixed_item>(source);
+	BOOST_CHECK(lfi.a == 1 && lfi.b == 2 && lfi.c == 3 && lfi.d == -4);
+	auto lpi = io::load<padded_item>(source);
+	BOOST_CHECK(lpi.a == 5 && lpi.b == 6);
+	auto lri = io::load<reordered_item>(source);
+	BOOST_CHECK(lri.a == 7 && lri.b == 8);
+	auto lni = io::load<nested_item>(source);
+	BOOST_CHECK(lni.f.d == -4 && lni.v == ni.v && lni.tail[2] == 11);
+	auto lmi = io::load<mixed_item>(source);
+	BOOST_CHECK(lmi.a == 13 && lmi.s == string("mixed") && lmi.flag);
+	BOOST_CHECK(!source.readable());
+
+	// fields are encoded one by one by a varint serializer
+	io::mem_archive ar3;
+	auto sink3 = io::exchange::as_sink(ar3, io::exchange::varint_encoding());
+	sink3 & fi;
+	BOOST_CHECK(ar3.size() == 4);
+	ar3.seek(0);
+	auto source3 = io::exchange::as_source(ar3, io::exchange::varint_encoding());
+	lfi = io::load<fixed_item>(source3);
+	BOOST_CHECK(lfi.a == 1 && lfi.b == 2 && lfi.c == 3 && lfi.d == -4);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
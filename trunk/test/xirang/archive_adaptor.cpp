@@ -9,6 +9,8 @@ $COMMON_HEAD_COMMENTS_CONTEXT$
 
 #include "./iarchive.h"
 
+#include <thread>
+
 BOOST_AUTO_TEST_SUITE(archive_adaptor_suite)
 using namespace xirang;
 using namespace xirang::io;
@@ -36,6 +38,9 @@ BOOST_AUTO_TEST_CASE(dummy_case)
 	test_adaptor<proxy_archive, io::random>::apply<proxy_random_p>();
 	test_adaptor<proxy_archive, read_map>::apply<proxy_read_map_p>();
 	test_adaptor<proxy_archive, write_map>::apply<proxy_write_map_p>();
+	test_adaptor<proxy_archive, positional_reader>::apply<proxy_positional_reader_p>();
+	test_adaptor<proxy_archive, vector_reader>::apply<proxy_vector_reader_p>();
+	test_adaptor<proxy_archive, vector_writer>::apply<proxy_vector_writer_p>();
 
 	test_adaptor<proxy_archive, reader, io::random>::apply<proxy_reader_p, proxy_forward_p>();
 }
@@ -137,6 +142,224 @@ BOOST_AUTO_TEST_CASE(sub_archive_case)
 	BOOST_CHECK(var == var2);
 }
 
+BOOST_AUTO_TEST_CASE(sub_positional_reader_case)
+{
+	mem_archive mar;
+	mar.data().resize(16);
+	for (std::size_t i = 0; i < mar.data().size(); ++i)
+		mar.data()[i] = byte(i);
+
+	auto adaptor = decorate<sub_archive
+		, sub_reader_p
+		, sub_random_p
+		, sub_positional_reader_p
+		>(mar, 4, 12);
+
+	archive_suite::ArchiveTester tester;
+	tester.check_positional_reader(adaptor);
+
+	buffer<byte> buf(16, byte(0xff));
+	auto rest = adaptor.read_at(6, to_range(buf));
+	BOOST_CHECK(rest.size() == 14);
+	BOOST_CHECK(buf[0] == byte(10) && buf[1] == byte(11) && buf[2] == byte(0xff));
+	BOOST_CHECK(adaptor.read_at(8, to_range(buf)).size() == 16);
+}
+
+BOOST_AUTO_TEST_CASE(vector_io_adaptor_case)
+{
+	mem_archive mar;
+	mar.data().resize(64, byte(0));
+
+	auto mul_adaptor = decorate<multiplex_archive
+		, multiplex_reader_p
+		, multiplex_random_p
+		, multiplex_vector_reader_p
+		, multiplex_vector_writer_p
+		>(mar, 8);
+	archive_suite::ArchiveTester tester;
+	tester.check_vector_io(mul_adaptor);
+
+	auto adaptor = decorate<sub_archive
+		, sub_reader_p
+		, sub_random_p
+		, sub_vector_reader_p
+		, sub_vector_writer_p
+		>(mar, 4, 36);
+	adaptor.seek(0);
+	tester.check_vector_io(adaptor, 8);
+
+	// clipped by the end of sub archive
+	buffer<byte> data(16, byte(1));
+	range<const byte*> wbufs[2] = { to_range(data), to_range(data) };
+	adaptor.seek(24);
+	BOOST_CHECK(adaptor.writev(make_range(wbufs, wbufs + 2)) == 8);
+	BOOST_CHECK(adaptor.offset() == 32);
+	BOOST_CHECK(std::count(mar.data().begin(), mar.data().end(), byte(1)) == 8);
+}
+
+BOOST_AUTO_TEST_CASE(buffered_archive_case)
+{
+	archive_suite::ArchiveTester tester;
+	{
+		mem_archive mar;
+		auto adaptor = decorate<buffered_archive
+			, buffered_reader_p
+			, buffered_writer_p
+			, buffered_random_p
+			, buffered_ioctrl_p
+			>(mar, 16);
+		tester.check_writer_random(adaptor);
+		adaptor.sync();
+		adaptor.seek(0);
+		tester.check_reader(adaptor);
+	}
+
+	mem_archive mar;
+	{
+		auto adaptor = decorate<buffered_archive
+			, buffered_reader_p
+			, buffered_writer_p
+			, buffered_random_p
+			>(mar, 16);
+
+		auto sink = local::as_sink(adaptor);
+		for (int i = 0; i < 100; ++i)
+			save(sink, i);
+		BOOST_CHECK(adaptor.offset() == 100 * sizeof(int));
+		BOOST_CHECK(adaptor.size() == 100 * sizeof(int));
+		BOOST_CHECK(mar.size() < 100 * sizeof(int));	// the tail is pending
+
+		// seek writes back pending data and reads are served from the read-ahead buffer
+		adaptor.seek(0);
+		BOOST_CHECK(mar.size() == 100 * sizeof(int));
+		auto source = local::as_source(adaptor);
+		BOOST_CHECK(load<int>(source) == 0);
+		BOOST_CHECK(load<int>(source) == 1);
+		BOOST_CHECK(adaptor.offset() == 2 * sizeof(int));
+		BOOST_CHECK(mar.offset() == 16);
+
+		// seek inside the read-ahead buffer
+		adaptor.seek(sizeof(int));
+		BOOST_CHECK(load<int>(source) == 1);
+
+		// write after read rewinds the underlying archive
+		save(sink, -1);
+		BOOST_CHECK(adaptor.offset() == 3 * sizeof(int));
+		BOOST_CHECK(load<int>(source) == 3);
+		adaptor.seek(2 * sizeof(int));
+		BOOST_CHECK(load<int>(source) == -1);
+
+		adaptor.seek(adaptor.size());
+		save(sink, 100);
+	}
+	// destructor writes back pending data
+	BOOST_CHECK(mar.size() == 101 * sizeof(int));
+
+	mar.seek(0);
+	iref<reader> rd(mar);
+	auto reader_only = decorate<buffered_archive, buffered_reader_p>(rd);
+	auto source = local::as_source(reader_only);
+	BOOST_CHECK(load<int>(source) == 0);
+	for (int i = 1; i < 100; ++i)
+		load<int>(source);
+	BOOST_CHECK(load<int>(source) == 100);
+	BOOST_CHECK(!reader_only.readable());
+}
+
+BOOST_AUTO_TEST_CASE(buffered_archive_flush_failure_case)
+{
+	byte data[8] = {};
+	fixed_buffer_io fixed(make_range(data, data + sizeof(data)));
+	auto adaptor = decorate<buffered_archive
+		, buffered_reader_p
+		, buffered_writer_p
+		>(fixed, 16);
+
+	// pending data doesn't fit the underlying archive, the read must not go on silently
+	byte out[12] = {};
+	adaptor.write(make_range((const byte*)out, (const byte*)out + sizeof(out)));
+	byte in[4];
+	BOOST_CHECK_THROW(adaptor.read(make_range(in, in + sizeof(in))), write_exception);
+}
+
+BOOST_AUTO_TEST_CASE(stats_archive_case)
+{
+	archive_suite::ArchiveTester tester;
+	mem_archive mar;
+	auto adaptor = decorate<stats_archive
+		, stats_reader_p
+		, stats_writer_p
+		, stats_random_p
+		, stats_options_p
+		>(mar);
+	tester.check_writer_random(adaptor);
+	adaptor.seek(0);
+	tester.check_reader(adaptor);
+
+	auto stats = any_cast<io_stats>(adaptor.getopt(ao_io_stats));
+	auto& rd = stats.counters[io_stats::op_read];
+	auto& wr = stats.counters[io_stats::op_write];
+	BOOST_CHECK(rd.calls > 0 && wr.calls > 0);
+	BOOST_CHECK(wr.bytes >= mar.size());
+	BOOST_CHECK(stats.counters[io_stats::op_seek].calls > 0);
+	long_size_t calls = 0;
+	for (auto& n : rd.histogram)
+		calls += n;
+	BOOST_CHECK(calls == rd.calls);
+
+	adaptor.sync();
+	stats = any_cast<io_stats>(adaptor.getopt(ao_io_stats));
+	BOOST_CHECK(stats.counters[io_stats::op_sync].calls == 1);
+
+	auto map_adaptor = decorate<stats_archive
+		, stats_read_map_p
+		, stats_options_p
+		>(mar);
+	{
+		auto view = map_adaptor.view_rd(ext_heap::handle(0, 10));
+	}
+	stats = any_cast<io_stats>(map_adaptor.getopt(ao_io_stats));
+	BOOST_CHECK(stats.counters[io_stats::op_view_rd].calls == 1);
+	BOOST_CHECK(stats.counters[io_stats::op_view_rd].bytes == 10);
+
+	adaptor.setopt(ao_io_stats, any());
+	stats = any_cast<io_stats>(adaptor.getopt(ao_io_stats));
+	BOOST_CHECK(stats.counters[io_stats::op_read].calls == 0);
+
+	BOOST_CHECK(io_stats::bucket_of(0) == 0);
+	BOOST_CHECK(io_stats::bucket_of(1) == 1);
+	BOOST_CHECK(io_stats::bucket_of(3) == 2);
+	BOOST_CHECK(io_stats::bucket_of(~long_size_t(0)) == io_stats::histogram_size - 1);
+}
+
+BOOST_AUTO_TEST_CASE(stats_archive_concurrent_read_at_case)
+{
+	mem_archive mar;
+	byte data[64] = {};
+	mar.write(make_range(data, data + sizeof(data)));
+
+	auto adaptor = decorate<stats_archive
+		, stats_positional_reader_p
+		, stats_options_p
+		>(mar);
+	const positional_reader& rd = adaptor;
+
+	const int threads = 4, loops = 1000;
+	std::vector<std::thread> workers;
+	for (int i = 0; i < threads; ++i)
+		workers.push_back(std::thread([&rd]{
+			byte buf[8];
+			for (int j = 0; j < loops; ++j)
+				rd.read_at(j % 8 * 8, make_range(buf, buf + sizeof(buf)));
+		}));
+	for (auto& t : workers)
+		t.join();
+
+	auto stats = any_cast<io_stats>(adaptor.getopt(ao_io_stats));
+	BOOST_CHECK(stats.counters[io_stats::op_read].calls == threads * loops);
+	BOOST_CHECK(stats.counters[io_stats::op_read].bytes == threads * loops * 8);
+}
+
 BOOST_AUTO_TEST_CASE(tail_archive_case)
 {
 	mem_archive mar;
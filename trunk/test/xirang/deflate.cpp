@@ -46,6 +46,31 @@ BOOST_AUTO_TEST_CASE(deflate_io_case){
 	BOOST_CHECK(!inflater.readable());
 	BOOST_CHECK(inflater.compressed_size() == dest1.size());
 }
+
+BOOST_AUTO_TEST_CASE(deflate_pipelined_case){
+	io::mem_archive src;
+	for (int i = 0; i < 100000; ++i){
+		byte b = byte(i % 251);
+		src.write(make_range(&b, &b + 1));
+	}
+	src.seek(0);
+
+	io::mem_archive zipped;
+	iref<io::reader> src_rd(src);
+	iref<io::writer> zipped_wr(zipped);
+	auto zret = zip::deflate_pipelined(src_rd.get<io::reader>(), zipped_wr.get<io::writer>());
+	BOOST_CHECK(zret.in_size == src.size());
+	BOOST_CHECK(zret.out_size == zipped.size());
+
+	zipped.seek(0);
+	io::mem_archive unzipped;
+	iref<io::reader> zipped_rd(zipped);
+	iref<io::writer> unzipped_wr(unzipped);
+	auto uret = zip::inflate_pipelined(zipped_rd.get<io::reader>(), unzipped_wr.get<io::writer>());
+	BOOST_CHECK(uret.out_size == src.size());
+	BOOST_CHECK(unzipped.size() == src.size());
+	BOOST_CHECK(std::equal(unzipped.data().begin(), unzipped.data().end(), src.data().begin()));
+}
 BOOST_AUTO_TEST_SUITE_END()
 
 
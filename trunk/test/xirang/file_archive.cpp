@@ -9,6 +9,9 @@ $COMMON_HEAD_COMMENTS_CONTEXT$
 #include <xirang/string_algo/utf8.h>
 
 //#include <iostream>
+#include <thread>
+#include <atomic>
+#include <vector>
 
 #include "iarchive.h"
 
@@ -151,5 +154,476 @@ BOOST_AUTO_TEST_CASE(file_archive)
 
     xirang::fs::recursive_remove(temp_path);
 }
+BOOST_AUTO_TEST_CASE(file_archive_map_window_case)
+{
+    file_path temp_path = fs::temp_dir(sub_file_path(literal("tfar_")));
+	file_path file_name =  temp_path / fs::private_::gen_temp_name(sub_file_path(literal("fa")));
+
+	const std::size_t K_Size = 64 * 1024;
+	buffer<xirang::byte> data;
+	for (std::size_t i = 0; i < K_Size; ++i)
+		data.push_back(xirang::byte(i * 7));
+
+	{
+		file wr(file_name, of_create_or_open);
+		wr.write(to_range(data));
+	}
+
+	file_reader rd(file_name);
+	BOOST_CHECK(any_cast<std::size_t>(rd.getopt(ao_map_window_count)) > 0);
+	rd.setopt(ao_map_window_size, std::size_t(1));	// round up to page size
+	std::size_t window_size = any_cast<std::size_t>(rd.getopt(ao_map_window_size));
+	BOOST_REQUIRE(window_size > 0);
+
+	buffer<xirang::byte> buf;
+	buf.resize(K_Size);
+	for (std::size_t i = 0; i < K_Size; i += 4)
+		rd.read(make_range(buf.begin() + i, buf.begin() + i + 4));
+	BOOST_CHECK(buf == data);
+	BOOST_CHECK(any_cast<long_size_t>(rd.getopt(ao_map_count)) == (K_Size + window_size - 1) / window_size);
+
+	// disable cache, map per call
+	rd.setopt(ao_map_window_count, std::size_t(0));
+	long_size_t map_count = any_cast<long_size_t>(rd.getopt(ao_map_count));
+	rd.seek(0);
+	buf.clear();
+	buf.resize(K_Size);
+	for (std::size_t i = 0; i < K_Size; i += 4)
+		rd.read(make_range(buf.begin() + i, buf.begin() + i + 4));
+	BOOST_CHECK(buf == data);
+	BOOST_CHECK(any_cast<long_size_t>(rd.getopt(ao_map_count)) - map_count == K_Size / 4);
+
+    xirang::fs::recursive_remove(temp_path);
+}
+BOOST_AUTO_TEST_CASE(file_archive_preallocate_case)
+{
+    file_path temp_path = fs::temp_dir(sub_file_path(literal("tfar_")));
+	file_path file_name =  temp_path / fs::private_::gen_temp_name(sub_file_path(literal("fa")));
+
+	const string text=literal("This is file archive UT content. --over--");
+	const std::size_t K_Count = 1000;
+	{
+		file wr(file_name, of_create_or_open | of_preallocate);
+		for (std::size_t i = 0; i < K_Count; ++i)
+			wr.write(string_to_c_range(text));
+
+		BOOST_CHECK(wr.size() == text.size() * K_Count);
+		BOOST_CHECK(fs::state(file_name).size > wr.size());
+
+		wr.seek(0);
+		buffer<xirang::byte> buf;
+		buf.resize(text.size());
+		wr.read(to_range(buf));
+		BOOST_CHECK(std::equal(buf.begin(), buf.end(), (const xirang::byte*)text.begin()));
+
+		wr.sync();
+		BOOST_CHECK(fs::state(file_name).size == wr.size());
+
+		wr.seek(wr.size());
+		wr.write(string_to_c_range(text));
+	}
+	BOOST_CHECK(fs::state(file_name).size == text.size() * (K_Count + 1));
+
+    xirang::fs::recursive_remove(temp_path);
+}
+BOOST_AUTO_TEST_CASE(file_archive_sync_policy_case)
+{
+    file_path temp_path = fs::temp_dir(sub_file_path(literal("tfar_")));
+	file_path file_name =  temp_path / fs::private_::gen_temp_name(sub_file_path(literal("fa")));
+
+	const string text=literal("This is file archive UT content. --over--");
+	{
+		file wr(file_name, of_create_or_open | of_sync_durable);
+		BOOST_CHECK(any_cast<sync_policy>(wr.getopt(ao_sync_policy)) == sp_durable);
+		wr.write(string_to_c_range(text));
+		wr.sync();
+
+		BOOST_CHECK(any_cast<sync_policy>(wr.setopt(ao_sync_policy, sp_async)) == sp_async);
+		wr.write(string_to_c_range(text));
+		wr.sync();
+
+		wr.setopt(ao_sync_policy, sp_none);
+		wr.write(string_to_c_range(text));
+	}
+	{
+		file_writer wr(file_name, of_open | of_sync_async);
+		BOOST_CHECK(any_cast<sync_policy>(wr.getopt(ao_sync_policy)) == sp_async);
+		BOOST_CHECK(wr.size() == text.size() * 3);
+	}
+
+    xirang::fs::recursive_remove(temp_path);
+}
+BOOST_AUTO_TEST_CASE(file_archive_access_hint_case)
+{
+    file_path temp_path = fs::temp_dir(sub_file_path(literal("tfar_")));
+	file_path file_name =  temp_path / fs::private_::gen_temp_name(sub_file_path(literal("fa")));
+
+	const string text=literal("This is file archive UT content. --over--");
+	int flags[] = { 0, of_stream_io };
+	for (auto flag : flags)
+	{
+		{
+			file wr(file_name, of_create_or_open | of_access_sequential | flag);
+			BOOST_CHECK(any_cast<access_hint>(wr.getopt(ao_access_hint)) == ah_sequential);
+			wr.write(string_to_c_range(text));
+		}
+		file_reader rd(file_name, of_open | of_access_random | flag);
+		BOOST_CHECK(any_cast<access_hint>(rd.getopt(ao_access_hint)) == ah_random);
+
+		// a hint of range doesn't change the hint of whole file
+		BOOST_CHECK(any_cast<access_hint>(rd.setopt(ao_access_hint, ah_willneed, ext_heap::handle(0, 10))) == ah_willneed);
+		BOOST_CHECK(any_cast<access_hint>(rd.getopt(ao_access_hint)) == ah_random);
+
+		rd.setopt(ao_access_hint, ah_dontneed);
+		BOOST_CHECK(any_cast<access_hint>(rd.getopt(ao_access_hint)) == ah_dontneed);
+
+		// hints don't change the content
+		buffer<xirang::byte> buf;
+		buf.resize(text.size());
+		BOOST_CHECK(rd.read(to_range(buf)).empty());
+		BOOST_CHECK(std::equal(buf.begin(), buf.end(), string_to_c_range(text).begin()));
+	}
+	BOOST_CHECK(access_hint_of(of_open | of_access_willneed) == ah_willneed);
+	BOOST_CHECK(access_hint_of(of_open) == ah_normal);
+
+    xirang::fs::recursive_remove(temp_path);
+}
+BOOST_AUTO_TEST_CASE(file_archive_async_io_case)
+{
+    file_path temp_path = fs::temp_dir(sub_file_path(literal("tfar_")));
+
+	const std::size_t K_Block = 4096;
+	const std::size_t K_Count = 64;
+	buffer<xirang::byte> data;
+	for (std::size_t i = 0; i < K_Block * K_Count; ++i)
+		data.push_back(xirang::byte(i * 7));
+
+	int flags[] = { of_preallocate, of_stream_io };
+	for (auto flag : flags)
+	{
+		file_path file_name =  temp_path / fs::private_::gen_temp_name(sub_file_path(literal("fa")));
+		{
+			file wr(file_name, of_create_or_open | flag);
+			wr.write(make_range(data.begin(), data.begin() + 10));	// buffered part is flushed before submission
+
+			// all blocks in flight, in reverse order
+			std::vector<async_result> results;
+			for (std::size_t i = K_Count; i > 0; --i)
+				results.push_back(wr.async_write((i - 1) * K_Block, make_range(data.begin() + (i - 1) * K_Block, data.begin() + i * K_Block)));
+			BOOST_CHECK(wr.size() == data.size());
+			for (auto& r : results)
+				BOOST_CHECK(r.get() == K_Block);
+			BOOST_CHECK(wr.offset() == 10);
+		}
+
+		file_reader rd(file_name, of_open | flag);
+		BOOST_REQUIRE(rd.size() == data.size());
+
+		buffer<xirang::byte> buf;
+		buf.resize(data.size());
+		std::vector<async_result> results;
+		for (std::size_t i = 0; i < K_Count; ++i)
+			results.push_back(rd.async_read(i * K_Block, make_range(buf.begin() + i * K_Block, buf.begin() + (i + 1) * K_Block)));
+		for (auto& r : results)
+			BOOST_CHECK(r.get() == K_Block);
+		BOOST_CHECK(buf == data);
+		BOOST_CHECK(rd.offset() == 0);
+
+		// short read at the end of file
+		BOOST_CHECK(rd.async_read(data.size() - 10, make_range(buf.begin(), buf.begin() + K_Block)).get() == 10);
+		BOOST_CHECK(rd.async_read(data.size() + 10, make_range(buf.begin(), buf.begin() + K_Block)).get() == 0);
+	}
+
+    xirang::fs::recursive_remove(temp_path);
+}
+BOOST_AUTO_TEST_CASE(file_archive_stream_io_case)
+{
+    file_path temp_path = fs::temp_dir(sub_file_path(literal("tfar_")));
+	file_path file_name =  temp_path / fs::private_::gen_temp_name(sub_file_path(literal("fa")));
+
+	const std::size_t K_Size = 300 * 1024;	// larger than the internal buffer
+	buffer<xirang::byte> data;
+	for (std::size_t i = 0; i < K_Size; ++i)
+		data.push_back(xirang::byte(i * 7));
+
+	{
+		file wr(file_name, of_create_or_open | of_stream_io);
+		for (std::size_t i = 0; i < K_Size; i += 1000)
+			wr.write(make_range(data.begin() + i, data.begin() + std::min(i + 1000, K_Size)));
+		BOOST_CHECK(wr.size() == K_Size);
+
+		// overwrite in the middle, then read back through the buffer
+		wr.seek(10);
+		wr.write(make_range(data.begin(), data.begin() + 10));
+		std::copy(data.begin(), data.begin() + 10, data.begin() + 10);
+
+		// write beyond eof leaves a zero gap
+		wr.seek(K_Size + 10);
+		wr.write(make_range(data.begin(), data.begin() + 10));
+		BOOST_CHECK(wr.size() == K_Size + 20);
+		wr.truncate(K_Size);
+	}
+	{
+		file_reader rd(file_name, of_stream_io);
+		buffer<xirang::byte> buf;
+		buf.resize(K_Size);
+		for (std::size_t i = 0; i < K_Size; i += 4)
+			rd.read(make_range(buf.begin() + i, buf.begin() + i + 4));
+		BOOST_CHECK(buf == data);
+		BOOST_CHECK(!rd.readable());
+
+		rd.seek(0);
+		buf.clear();
+		buf.resize(K_Size);
+		BOOST_CHECK(rd.read(to_range(buf)).empty());
+		BOOST_CHECK(buf == data);
+
+		ArchiveTester tester;
+		rd.seek(0);
+		tester.check_reader(rd);
+		tester.check_random(rd);
+		tester.check_positional_reader(rd);
+	}
+	{
+		file rw(file_name, of_open | of_stream_io);
+		rw.seek(K_Size - 4);
+		rw.write(make_range(data.begin(), data.begin() + 2));	// still in buffer
+		std::copy(data.begin(), data.begin() + 2, data.end() - 4);
+		buffer<xirang::byte> buf;
+		buf.resize(8);
+		BOOST_CHECK(rw.read_at(K_Size - 8, to_range(buf)).empty());
+		BOOST_CHECK(std::equal(buf.begin(), buf.end(), data.end() - 8));
+	}
+	{
+		file rw(file_name, of_open | of_stream_io);
+		{
+			auto view = rw.view_wr(ext_heap::handle(K_Size - 4, K_Size + 4));
+			auto addr = view->address();
+			BOOST_CHECK(std::equal(addr.begin(), addr.begin() + 4, data.end() - 4));
+			std::fill(addr.begin(), addr.end(), xirang::byte(1));
+		}
+		BOOST_CHECK(rw.size() == K_Size + 4);
+
+		auto view = rw.view_rd(ext_heap::handle(K_Size - 8, K_Size + 4));
+		auto addr = view->address();
+		BOOST_CHECK(std::equal(addr.begin(), addr.begin() + 4, data.end() - 8));
+		BOOST_CHECK(std::count(addr.begin() + 4, addr.end(), xirang::byte(1)) == 8);
+
+		rw.truncate(0);
+		ArchiveTester tester;
+		tester.check_vector_io(rw);
+		tester.check_vector_io(rw, 40 * 1024);	// bypass the buffer
+		rw.seek(0);
+		tester.check_writer(rw);
+		rw.seek(0);
+		tester.check_reader(rw);
+		tester.check_random(rw);
+	}
+
+    xirang::fs::recursive_remove(temp_path);
+}
+BOOST_AUTO_TEST_CASE(file_archive_read_at_case)
+{
+    file_path temp_path = fs::temp_dir(sub_file_path(literal("tfar_")));
+	file_path file_name =  temp_path / fs::private_::gen_temp_name(sub_file_path(literal("fa")));
+
+	const std::size_t K_Size = 256 * 1024;
+	buffer<xirang::byte> data;
+	for (std::size_t i = 0; i < K_Size; ++i)
+		data.push_back(xirang::byte(i * 7));
+	{
+		file wr(file_name, of_create_or_open | of_preallocate);
+		wr.write(to_range(data));
+
+		ArchiveTester tester;
+		tester.check_positional_reader(wr);
+		wr.seek(wr.size());
+		tester.check_vector_io(wr);
+	}
+
+	file_reader rd(file_name);
+	ArchiveTester tester;
+	tester.check_positional_reader(rd);
+
+	// concurrent read_at on shared archive
+	rd.seek(0);
+	const std::size_t K_Block = 4096;
+	std::vector<std::thread> threads;
+	std::atomic<int> errors(0);
+	for (int t = 0; t < 4; ++t)
+	{
+		threads.push_back(std::thread([&, t]{
+			buffer<xirang::byte> buf;
+			buf.resize(K_Block);
+			for (std::size_t i = t * K_Block; i < K_Size; i += 4 * K_Block)
+			{
+				if (!rd.read_at(i, to_range(buf)).empty()
+						|| !std::equal(buf.begin(), buf.end(), data.begin() + i))
+					++errors;
+			}
+		}));
+	}
+	for (auto& th : threads)
+		th.join();
+	BOOST_CHECK(errors == 0);
+	BOOST_CHECK(rd.offset() == 0);
+
+    xirang::fs::recursive_remove(temp_path);
+}
+BOOST_AUTO_TEST_CASE(file_archive_native_copy_case)
+{
+    file_path temp_path = fs::temp_dir(sub_file_path(literal("tfar_")));
+	file_path src_name =  temp_path / file_path(literal("src"));
+
+	const std::size_t K_Size = 64 * 1024 + 100;
+	buffer<xirang::byte> data;
+	for (std::size_t i = 0; i < K_Size; ++i)
+		data.push_back(xirang::byte(i * 7));
+	{
+		file wr(src_name, of_create_or_open | of_preallocate);
+		wr.write(to_range(data));
+	}
+
+	int flags[] = { of_preallocate, of_stream_io };
+	for (auto flag : flags)
+	{
+		file_path dest_name =  temp_path / fs::private_::gen_temp_name(sub_file_path(literal("fa")));
+		file_reader rd(src_name);
+		file wr(dest_name, of_create_or_open | flag);
+
+		// head part via buffer, make sure the buffered data is flushed before kernel copy
+		wr.write(make_range(data.begin(), data.begin() + 10));
+		rd.seek(10);
+		BOOST_CHECK(copy_data(rd, wr) == K_Size - 10);
+		BOOST_CHECK(rd.offset() == K_Size);
+		BOOST_CHECK(wr.offset() == K_Size);
+		BOOST_CHECK(wr.size() == K_Size);
+
+		buffer<xirang::byte> buf;
+		buf.resize(K_Size);
+		BOOST_CHECK(wr.read_at(0, to_range(buf)).empty());
+		BOOST_CHECK(buf == data);
+
+		buf.clear();
+		buf.resize(K_Size);
+		wr.seek(0);
+		BOOST_CHECK(block_read(wr, to_range(buf)).empty());
+		BOOST_CHECK(buf == data);
+
+		// max_size
+		rd.seek(0);
+		wr.seek(0);
+		BOOST_CHECK(copy_data(rd, wr, 100) == 100);
+		BOOST_CHECK(rd.offset() == 100);
+		BOOST_CHECK(wr.size() == K_Size);
+	}
+
+	file_path copy_name =  temp_path / file_path(literal("copy"));
+	fs::copy(src_name, copy_name);
+	BOOST_CHECK(fs::state(copy_name).size == K_Size);
+
+    xirang::fs::recursive_remove(temp_path);
+}
+BOOST_AUTO_TEST_CASE(file_archive_direct_io_case)
+{
+    file_path temp_path = fs::temp_dir(sub_file_path(literal("tfar_")));
+	file_path file_name =  temp_path / fs::private_::gen_temp_name(sub_file_path(literal("fa")));
+
+	const std::size_t K_Size = 300 * 1024 + 123;	// unaligned tail
+	buffer<xirang::byte> data;
+	for (std::size_t i = 0; i < K_Size; ++i)
+		data.push_back(xirang::byte(i * 7));
+
+	{
+		// direct io is optional, the content must be same either way
+		file wr(file_name, of_create_or_open | of_direct_io);
+		BOOST_CHECK(!wr.getopt(ao_direct_io).empty());
+
+		wr.write(make_range(data.begin(), data.begin() + 10));	// unaligned head, buffered
+		wr.write(make_range(data.begin() + 10, data.begin() + 100 * 1024 + 1));	// large write from unaligned memory
+		wr.write(make_range(data.begin() + 100 * 1024 + 1, data.end()));
+		BOOST_CHECK(wr.size() == K_Size);
+
+		// overwrite in the middle, the buffer is flushed in aligned blocks
+		wr.seek(5000);
+		wr.write(make_range(data.begin(), data.begin() + 10));
+		std::copy(data.begin(), data.begin() + 10, data.begin() + 5000);
+
+		range<const xirang::byte*> bufs[] = {
+			make_range(data.begin(), data.begin() + 3),
+			make_range(data.begin() + 3, data.begin() + 70 * 1024)
+		};
+		wr.seek(0);
+		BOOST_CHECK(wr.writev(make_range(bufs, bufs + 2)) == 70 * 1024);
+
+		buffer<xirang::byte> buf;
+		buf.resize(K_Size);
+		BOOST_CHECK(wr.read_at(0, to_range(buf)).empty());
+		BOOST_CHECK(buf == data);
+	}
+	{
+		file_reader rd(file_name);
+		BOOST_CHECK(rd.size() == K_Size);
+		buffer<xirang::byte> buf;
+		buf.resize(K_Size);
+		BOOST_CHECK(block_read(rd, to_range(buf)).empty());
+		BOOST_CHECK(buf == data);
+	}
+
+    xirang::fs::recursive_remove(temp_path);
+}
+BOOST_AUTO_TEST_CASE(file_archive_view_copy_case)
+{
+    file_path temp_path = fs::temp_dir(sub_file_path(literal("tfar_")));
+	file_path src_name =  temp_path / file_path(literal("src"));
+
+	const std::size_t K_Size = 1024 * 1024 + 100;
+	buffer<xirang::byte> data;
+	for (std::size_t i = 0; i < K_Size; ++i)
+		data.push_back(xirang::byte(i * 7));
+	{
+		file wr(src_name, of_create_or_open);
+		wr.write(to_range(data));
+	}
+
+	view_options opts;
+	opts.initial_size = 100;	// rounded up to granularity
+	opts.max_size = 256 * 1024;
+
+	int flags[] = { 0, of_map_populate, of_map_populate | of_map_hugepage, of_stream_io };
+	for (auto flag : flags)
+	{
+		file_path dest_name =  temp_path / fs::private_::gen_temp_name(sub_file_path(literal("fa")));
+		file_reader rd(src_name, flag);
+		file wr(dest_name, of_create_or_open | flag);
+		iref<read_map> rmap(rd);
+		iref<write_map> wmap(wr);
+		BOOST_CHECK(copy_data(rmap.get<read_map>(), wmap.get<write_map>(), ~0, opts) == K_Size);
+		BOOST_CHECK(wr.size() == K_Size);
+
+		buffer<xirang::byte> buf;
+		buf.resize(K_Size);
+		BOOST_CHECK(wr.read_at(0, to_range(buf)).empty());
+		BOOST_CHECK(buf == data);
+
+		// reader to write_map truncates the over-mapped tail
+		file_path dest2 =  temp_path / fs::private_::gen_temp_name(sub_file_path(literal("fa")));
+		file wr2(dest2, of_create_or_open | flag);
+		iref<write_map> wmap2(wr2);
+		iref<reader> rd2(rd);
+		rd.seek(0);
+		BOOST_CHECK(copy_data(rd2.get<reader>(), wmap2.get<write_map>(), ~0, opts) == K_Size);
+		BOOST_CHECK(wr2.size() == K_Size);
+
+		// read_map to writer with max_size
+		file_path dest3 =  temp_path / fs::private_::gen_temp_name(sub_file_path(literal("fa")));
+		file wr3(dest3, of_create_or_open | flag);
+		iref<writer> wr3_i(wr3);
+		BOOST_CHECK(copy_data(rmap.get<read_map>(), wr3_i.get<writer>(), 300 * 1024, opts) == 300 * 1024);
+		BOOST_CHECK(wr3.size() == 300 * 1024);
+	}
+
+    xirang::fs::recursive_remove(temp_path);
+}
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,309 @@
+/*
+$COMMON_HEAD_COMMENTS_CONTEXT$
+*/
+
+#include "precompile.h"
+#include <xirang/heap.h>
+#include <xirang/heap/tracking_heap.h>
+#include <xirang/buffer.h>
+#include <xirang/deflate.h>
+#include <xirang/io/memory.h>
+
+//STL
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(heap_suite)
+using namespace xirang;
+
+namespace {
+	/// count the blocks allocated from the underling heap
+	struct counting_heap : heap
+	{
+		counting_heap() : under(memory::single_thread), blocks(0), bytes(0){}
+
+		virtual void* malloc(std::size_t size, std::size_t alignment, const void* hint){
+			++blocks;
+			bytes += size;
+			return under.malloc(size, alignment, hint);
+		}
+		virtual void free(void* p, std::size_t size, std::size_t alignment){
+			--blocks;
+			bytes -= size;
+			under.free(p, size, alignment);
+		}
+		virtual heap* underling(){ return &under;}
+		virtual bool equal_to(const heap& rhs) const { return this == &rhs;}
+
+		plain_heap under;
+		int blocks;
+		std::size_t bytes;
+	};
+
+	bool aligned(void* p, std::size_t alignment){
+		return (reinterpret_cast<std::uintptr_t>(p) & (alignment - 1)) == 0;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(pool_heap_case)
+{
+	counting_heap under;
+	{
+		pool_heap pool(&under, memory::single_thread);
+		BOOST_CHECK(pool.underling() == &under);
+		BOOST_CHECK(pool.equal_to(pool));
+		BOOST_CHECK(!pool.equal_to(under));
+
+		void* p = pool.malloc(24, 8, 0);
+		BOOST_CHECK(under.blocks == 1);	// one segment
+		std::memset(p, 0x5a, 24);
+		pool.free(p, 24, 8);
+		BOOST_CHECK(pool.malloc(20, 1, 0) == p);	// same size class, reused
+		pool.free(p, 20, 0);
+
+		std::vector<void*> blocks;
+		for (std::size_t size = 0; size <= 4096; size += 7){
+			void* q = pool.malloc(size, 16, 0);
+			BOOST_CHECK(aligned(q, 16));
+			std::memset(q, int(size), size);
+			blocks.push_back(q);
+		}
+		for (std::size_t alignment = 1; alignment <= 4096; alignment *= 2){
+			void* q = pool.malloc(100, alignment, 0);
+			BOOST_CHECK(aligned(q, alignment));
+			pool.free(q, 100, alignment);
+		}
+		int segments = under.blocks;
+		for (std::size_t size = 0, i = 0; size <= 4096; size += 7, ++i){
+			auto q = static_cast<unsigned char*>(blocks[i]);
+			BOOST_CHECK(size == 0 || (q[0] == (unsigned char)size && q[size - 1] == (unsigned char)size));
+			pool.free(q, i % 2 == 0 ? size : 0, 16);	// unknown size is searched
+		}
+
+		// large blocks are forwarded
+		p = pool.malloc(10000, 16, 0);
+		BOOST_CHECK(under.blocks == segments + 1);
+		pool.free(p, 10000, 16);
+		p = pool.malloc(100, 8192, 0);
+		BOOST_CHECK(under.blocks == segments + 1);
+		pool.free(p, 100, 8192);
+		BOOST_CHECK(under.blocks == segments);
+	}
+	BOOST_CHECK(under.blocks == 0);
+	BOOST_CHECK(under.bytes == 0);
+}
+
+BOOST_AUTO_TEST_CASE(pool_heap_multi_thread_case)
+{
+	counting_heap under;
+	{
+		pool_heap pool(&under, memory::multi_thread);
+
+		const std::size_t count = 10000;
+		std::vector<std::vector<uint32_t*> > outputs(4);
+		std::vector<std::thread> threads;
+		for (std::size_t t = 0; t < outputs.size(); ++t){
+			threads.push_back(std::thread([&pool, &outputs, t, count]{
+				std::vector<uint32_t*> local;
+				for (std::size_t i = 0; i < count; ++i){
+					std::size_t size = 8 + (i % 64) * 8;
+					auto p = static_cast<uint32_t*>(pool.malloc(size, 4, 0));
+					p[0] = uint32_t(size);
+					p[size / 4 - 1] = uint32_t(t);
+					if (i % 3 == 0)
+						local.push_back(p);
+					else
+						outputs[t].push_back(p);
+				}
+				for (auto p : local)
+					pool.free(p, p[0], 4);
+			}));
+		}
+		for (auto& i : threads)
+			i.join();
+		threads.clear();
+
+		// free the blocks in other threads
+		std::vector<int> results(outputs.size());
+		for (std::size_t t = 0; t < outputs.size(); ++t){
+			threads.push_back(std::thread([&pool, &outputs, &results, t]{
+				auto& blocks = outputs[(t + 1) % outputs.size()];
+				bool ok = true;
+				for (auto p : blocks){
+					ok = ok && p[p[0] / 4 - 1] == uint32_t((t + 1) % outputs.size());
+					pool.free(p, p[0], 4);
+				}
+				blocks.clear();
+				results[t] = ok;
+			}));
+		}
+		for (auto& i : threads)
+			i.join();
+		for (auto i : results)
+			BOOST_CHECK(i);
+
+		void* p = pool.malloc(64, 8, 0);
+		pool.prepare_destroy();
+		pool.free(p, 64, 8);
+		BOOST_CHECK(pool.malloc(64, 8, 0) == p);	// no thread cache
+		pool.free(p, 64, 8);
+	}
+	BOOST_CHECK(under.blocks == 0);
+}
+
+BOOST_AUTO_TEST_CASE(thread_caching_heap_case)
+{
+	heap& caching = memory::get_thread_caching_heap();
+	BOOST_CHECK(&caching == &memory::get_thread_caching_heap());
+	BOOST_CHECK(dynamic_cast<pool_heap*>(&caching) != 0);
+
+	heap_saver saver(caching);
+	BOOST_CHECK(&memory::get_global_heap() == &caching);
+
+	string text("quick fox jump over the lazy dog");
+	BOOST_CHECK(&text.get_heap() == &caching);
+	auto first = (const byte*)&*text.begin();
+	buffer<byte> buf;
+	for (int i = 0; i < 1000; ++i)
+		buf.append(make_range(first, first + text.size()));
+	BOOST_CHECK(buf.size() == 1000 * text.size());
+
+	// zlib frees its blocks with unknown size
+	io::mem_archive dest;
+	{
+		iref<io::write_map> zip_dest(dest);
+		zip::deflate_writer deflater(zip_dest.get<io::write_map>(), zip::zm_raw_deflate, zip::zl_default, zip::dict_type(), &caching);
+		deflater.write(make_range(buf.data(), buf.data() + buf.size()));
+		deflater.finish();
+	}
+	io::mem_archive inflated;
+	iref<io::read_map> zip_src(dest);
+	zip::inflate_reader inflater(zip_src.get<io::read_map>(), zip::zm_raw_deflate, long_size_t(-1), zip::dict_type(), &caching);
+	io::copy_data<io::reader, io::writer>(inflater, inflated);
+	BOOST_CHECK(inflated.data() == buf);
+}
+
+BOOST_AUTO_TEST_CASE(arena_heap_case)
+{
+	counting_heap under;
+	{
+		arena_heap arena(&under, memory::single_thread, 1024);
+		BOOST_CHECK(arena.underling() == &under);
+		BOOST_CHECK(arena.equal_to(arena));
+		BOOST_CHECK(arena.reserved_size() == 0);
+
+		auto p1 = static_cast<char*>(arena.malloc(10, 2, 0));
+		auto p2 = static_cast<char*>(arena.malloc(8, 8, 0));
+		BOOST_CHECK(under.blocks == 1);
+		BOOST_CHECK(p2 > p1 && p2 - p1 <= 16 && aligned(p2, 8));
+		arena.free(p2, 8, 8);
+		BOOST_CHECK(arena.malloc(8, 8, 0) != p2);	// free does nothing
+
+		for (int i = 0; i < 100; ++i)
+			BOOST_CHECK(aligned(arena.malloc(100, 32, 0), 32));
+		int chunks = under.blocks;
+		BOOST_CHECK(chunks > 1);
+
+		// oversized blocks
+		void* large = arena.malloc(1000, 64, 0);
+		BOOST_CHECK(aligned(large, 64));
+		BOOST_CHECK(under.blocks == chunks + 1);
+		arena.free(large, 1000, 64);
+		BOOST_CHECK(under.blocks == chunks);
+		arena.malloc(1000, 64, 0);
+		BOOST_CHECK(under.blocks == chunks + 1);
+		BOOST_CHECK(arena.reserved_size() == under.bytes);
+
+		// the last chunk is kept
+		arena.reset();
+		BOOST_CHECK(under.blocks == 1);
+		BOOST_CHECK(arena.reserved_size() == under.bytes);
+		arena.malloc(100, 8, 0);
+		BOOST_CHECK(under.blocks == 1);
+
+		arena.release_all();
+		BOOST_CHECK(under.blocks == 0);
+		BOOST_CHECK(arena.reserved_size() == 0);
+
+		{
+			heap_saver saver(arena);
+			string text("quick fox jump over the lazy dog");
+			BOOST_CHECK(&text.get_heap() == &arena);
+			buffer<byte> buf;
+			for (int i = 0; i < 100; ++i)
+				buf.append(make_range((const byte*)text.data(), (const byte*)text.data() + text.size()));
+			BOOST_CHECK(buf.size() == 100 * text.size());
+		}
+		BOOST_CHECK(under.blocks > 0);
+	}
+	BOOST_CHECK(under.blocks == 0);
+	BOOST_CHECK(under.bytes == 0);
+}
+
+BOOST_AUTO_TEST_CASE(tracking_heap_case)
+{
+	counting_heap under;
+	tracking_heap tracker(&under);
+	BOOST_CHECK(tracker.underling() == &under);
+	BOOST_CHECK(tracker.equal_to(tracker));
+
+	void* p1 = tracker.malloc(10, 1, 0);
+	void* p2 = 0;
+	{
+		heap_tag_scope tag("tag \"1\"");
+		p2 = tracker.malloc(100, 8, 0);
+		{
+			heap_tag_scope tag2("tag2");
+			tracker.free(tracker.malloc(1000, 8, 0), 1000, 8);
+		}
+	}
+	BOOST_CHECK(under.blocks == 2);
+
+	auto stat = tracker.snapshot();
+	BOOST_CHECK(stat.live_bytes == 110);
+	BOOST_CHECK(stat.live_blocks == 2);
+	BOOST_CHECK(stat.peak_bytes == 1110);
+	BOOST_CHECK(stat.peak_blocks == 3);
+	BOOST_CHECK(stat.total_allocs == 3);
+	BOOST_CHECK(stat.total_frees == 1);
+	BOOST_CHECK(stat.total_bytes == 1110);
+	BOOST_CHECK(stat.histogram[4] == 1);	// (8, 16]
+	BOOST_CHECK(stat.histogram[7] == 1);	// (64, 128]
+	BOOST_CHECK(stat.histogram[10] == 1);	// (512, 1024]
+	BOOST_CHECK(stat.alloc_rate() >= 0);
+
+	tracker.free(p2, 0, 0);
+	stat = tracker.snapshot();
+	BOOST_CHECK(stat.unsized_frees == 1);
+	BOOST_CHECK(stat.live_blocks == 1);
+#ifdef AIO_HEAP_TRACKING_TAGS
+	BOOST_CHECK(stat.live_bytes == 10);	// size is recorded
+	BOOST_CHECK(stat.tags.size() == 3);
+	BOOST_CHECK(stat.tags[0].tag == 0 && stat.tags[0].live_bytes == 10);
+	BOOST_CHECK(string(stat.tags[1].tag) == string("tag \"1\"") && stat.tags[1].live_blocks == 0 && stat.tags[1].total_bytes == 100);
+	BOOST_CHECK(string(stat.tags[2].tag) == string("tag2") && stat.tags[2].total_allocs == 1);
+#else
+	BOOST_CHECK(stat.live_bytes == 110);
+	BOOST_CHECK(stat.tags.empty());
+#endif
+	tracker.reset_peak();
+	BOOST_CHECK(tracker.snapshot().peak_blocks == 1);
+
+	std::string text = format_text(stat).c_str();
+	BOOST_CHECK(text.find("live: ") == 0);
+	std::string json = format_json(stat).c_str();
+	BOOST_CHECK(json.find("{\"live_bytes\":") == 0);
+	BOOST_CHECK(json.find("\"histogram\":[{\"max_size\":16,\"count\":1}") != std::string::npos);
+#ifdef AIO_HEAP_TRACKING_TAGS
+	BOOST_CHECK(json.find("{\"tag\":\"tag \\\"1\\\"\"") != std::string::npos);
+#endif
+
+	tracker.free(p1, 10, 1);
+	BOOST_CHECK(under.blocks == 0);
+	BOOST_CHECK(tracker.snapshot().live_blocks == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -66,6 +66,78 @@ ArchiveTester& ArchiveTester::check_reader_random(iref<io::reader, io::random> a
 
 }
 
+ArchiveTester& ArchiveTester::check_positional_reader(iref<io::reader, io::random, io::positional_reader> ar)
+{
+	io::reader* rd = &ar.get<io::reader>();
+	io::random* rnd = &ar.get<io::random>();
+	io::positional_reader* prd = &ar.get<io::positional_reader>();
+
+	size_t size = (size_t)rnd->size();
+	BOOST_REQUIRE(size > 1);
+
+	buffer<xirang::byte> expect;
+	expect.resize(size);
+	rnd->seek(0);
+	BOOST_REQUIRE(block_read(*rd, to_range(expect)).empty());
+
+	rnd->seek(1);
+	buffer<xirang::byte> buf;
+	buf.resize(size);
+	auto reset = prd->read_at(0, to_range(buf));
+	BOOST_CHECK(reset.empty());
+	BOOST_CHECK(buf == expect);
+	BOOST_CHECK(rnd->offset() == 1);
+
+	reset = prd->read_at(size / 2, to_range(buf));
+	BOOST_CHECK(reset.size() == size / 2);
+	BOOST_CHECK(std::equal(buf.begin(), reset.begin(), expect.begin() + size / 2));
+
+	reset = prd->read_at(size, to_range(buf));
+	BOOST_CHECK(reset.size() == buf.size());
+	BOOST_CHECK(rnd->offset() == 1);
+
+	return *this;
+}
+
+ArchiveTester& ArchiveTester::check_vector_io(iref<io::reader, io::random, io::vector_reader, io::vector_writer> ar, std::size_t piece_size)
+{
+	io::reader* rd = &ar.get<io::reader>();
+	io::random* rnd = &ar.get<io::random>();
+
+	buffer<xirang::byte> data;
+	for (std::size_t i = 0; i < piece_size * 3; ++i)
+		data.push_back(xirang::byte(i * 3));
+	range<const xirang::byte*> wbufs[3] = {
+		make_range(data.begin(), data.begin() + 1),
+		make_range(data.begin() + 1, data.begin() + piece_size * 2),
+		make_range(data.begin() + piece_size * 2, data.end())
+	};
+
+	auto start = rnd->offset();
+	auto wsize = ar.get<io::vector_writer>().writev(make_range(wbufs, wbufs + 3));
+	BOOST_CHECK(wsize == data.size());
+	BOOST_CHECK(rnd->offset() == start + data.size());
+
+	rnd->seek(start);
+	buffer<xirang::byte> buf;
+	buf.resize(data.size());
+	BOOST_REQUIRE(block_read(*rd, to_range(buf)).empty());
+	BOOST_CHECK(buf == data);
+
+	buffer<xirang::byte> first, second;
+	first.resize(piece_size);
+	second.resize(data.size());		// longer than the rest
+	range<xirang::byte*> rbufs[2] = { to_range(first), to_range(second) };
+	rnd->seek(start);
+	auto rsize = ar.get<io::vector_reader>().readv(make_range(rbufs, rbufs + 2));
+	BOOST_CHECK(rsize == std::min<long_size_t>(rnd->size() - start, first.size() + second.size()));
+	BOOST_CHECK(std::equal(first.begin(), first.end(), data.begin()));
+	BOOST_CHECK(std::equal(data.begin() + piece_size, data.end(), second.begin()));
+	BOOST_CHECK(rnd->offset() == start + rsize);
+
+	return *this;
+}
+
 ArchiveTester& ArchiveTester::check_writer(iref<io::writer> ar)
 {
 	io::writer* wr = &ar.get<io::writer>();
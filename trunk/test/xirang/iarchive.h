@@ -17,6 +17,8 @@ class ArchiveTester
 	ArchiveTester& check_random(iref<io::random>);
 	ArchiveTester& check_reader_random(iref<io::reader, io::random> ar);
 	ArchiveTester& check_writer_random(iref<io::writer, io::random> ar);
+	ArchiveTester& check_positional_reader(iref<io::reader, io::random, io::positional_reader> ar);
+	ArchiveTester& check_vector_io(iref<io::reader, io::random, io::vector_reader, io::vector_writer> ar, std::size_t piece_size = 16);
 
 	ArchiveTester& check_rd_view(iref<io::read_view>);
 	ArchiveTester& check_wr_view(iref<io::write_view>);
@@ -5,6 +5,8 @@ $COMMON_HEAD_COMMENTS_CONTEXT$
 #include "precompile.h"
 #include <xirang/io.h>
 #include <xirang/io/memory.h>
+#include <xirang/io/parallel_copy.h>
+#include <xirang/deflate.h>
 
 BOOST_AUTO_TEST_SUITE(io_suite)
 	using namespace xirang;
@@ -43,5 +45,97 @@ BOOST_AUTO_TEST_CASE(copy_data_case){
 	BOOST_CHECK(dest1.data().size() == text.size());
 
 }
+namespace {
+	/// reader throws after given bytes
+	struct failed_reader{
+		explicit failed_reader(long_size_t fail_at) : pos(0), fail_at(fail_at){}
+		range<byte*> read(const range<byte*>& buf){
+			if (pos + buf.size() > fail_at)
+				AIO_THROW(io::read_exception);
+			pos += buf.size();
+			return range<byte*>(buf.end(), buf.end());
+		}
+		bool readable() const { return true;}
+		long_size_t pos;
+		long_size_t fail_at;
+	};
+}
+
+BOOST_AUTO_TEST_CASE(copy_data_pipelined_case){
+	buffer<byte> data;
+	for (std::size_t i = 0; i < 10000; ++i)
+		data.push_back(byte(i * 7));
+
+	io::pipeline_options opts;
+	opts.buffer_size = 64;
+	opts.buffer_count = 3;
+
+	io::buffer_in src(data);
+	io::mem_archive dest;
+	iref<io::reader> rd(src);
+	iref<io::writer> wr(dest);
+	BOOST_CHECK(io::copy_data_pipelined(rd.get<io::reader>(), wr.get<io::writer>(), ~0, opts) == data.size());
+	BOOST_CHECK(dest.data() == data);
+
+	// max_size
+	src.seek(0);
+	dest.truncate(0);
+	dest.seek(0);
+	BOOST_CHECK(io::copy_data_pipelined(rd.get<io::reader>(), wr.get<io::writer>(), 1000, opts) == 1000);
+	BOOST_CHECK(src.offset() == 1000);
+	BOOST_CHECK(std::equal(dest.data().begin(), dest.data().end(), data.begin()));
+
+	// writer is full
+	src.seek(0);
+	buffer<byte> small(100, byte(0));
+	io::fixed_buffer_io fixed(to_range(small));
+	iref<io::writer> wr2(fixed);
+	BOOST_CHECK(io::copy_data_pipelined(rd.get<io::reader>(), wr2.get<io::writer>(), ~0, opts) == 100);
+	BOOST_CHECK(std::equal(small.begin(), small.end(), data.begin()));
+
+	// reader error
+	failed_reader bad(1000);
+	iref<io::reader> rd3(bad);
+	dest.truncate(0);
+	dest.seek(0);
+	BOOST_CHECK_THROW(io::copy_data_pipelined(rd3.get<io::reader>(), wr.get<io::writer>(), ~0, opts), io::read_exception);
+}
+BOOST_AUTO_TEST_CASE(copy_data_parallel_case){
+	buffer<byte> data;
+	for (std::size_t i = 0; i < 1000 * 1000; ++i)
+		data.push_back(byte(i * 7));
+
+	io::parallel_copy_options opts;
+	BOOST_CHECK(opts.threads >= 1);
+	opts.threads = 4;			// use the workers even on a single core
+	opts.chunk_size = 100;		// rounded up to 64KB
+	opts.min_size = 0;
+	opts.checksum = io::ck_crc32;
+
+	io::buffer_in src(data);
+	io::mem_archive dest;
+	iref<io::read_map> rd(src);
+	iref<io::write_map> wr(dest);
+	std::vector<io::chunk_checksum> sums;
+	BOOST_CHECK(io::copy_data_parallel(rd.get<io::read_map>(), wr.get<io::write_map>(), ~0, opts, &sums) == data.size());
+	BOOST_CHECK(dest.data() == data);
+	BOOST_CHECK(sums.size() == (data.size() + 64 * 1024 - 1) / (64 * 1024));
+	for (auto& i : sums)
+		BOOST_CHECK(i.crc32 == zip::crc32(make_range(data.begin() + i.first, data.begin() + i.last)));
+	BOOST_CHECK(sums.back().last == data.size());
+
+	// sha1 in current thread, with max_size
+	opts.min_size = ~0;
+	opts.checksum = io::ck_sha1;
+	io::mem_archive dest2;
+	iref<io::write_map> wr2(dest2);
+	BOOST_CHECK(io::copy_data_parallel(rd.get<io::read_map>(), wr2.get<io::write_map>(), 1000, opts, &sums) == 1000);
+	BOOST_CHECK(dest2.data().size() == 1000);
+	BOOST_CHECK(std::equal(dest2.data().begin(), dest2.data().end(), data.begin()));
+	BOOST_CHECK(sums.size() == 1);
+	sha1 sha;
+	sha.write(make_range(data.begin(), data.begin() + 1000));
+	BOOST_CHECK(sums[0].sha1 == sha.get_digest());
+}
 BOOST_AUTO_TEST_SUITE_END()
 
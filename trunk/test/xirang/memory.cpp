@@ -4,6 +4,8 @@ $COMMON_HEAD_COMMENTS_CONTEXT$
 
 #include "precompile.h"
 #include <xirang/memory.h>
+#include <xirang/heap.h>
+#include <xirang/buffer.h>
 #include <xirang/assert.h>
 
 //BOOST
@@ -11,6 +13,7 @@ $COMMON_HEAD_COMMENTS_CONTEXT$
 
 //STL
 #include <string>
+#include <thread>
 
 BOOST_AUTO_TEST_SUITE(memory_suite)
 
@@ -70,4 +73,41 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(abi_allocator_case, T, test_types)
 	unuse(alloc2);
 
 }
+BOOST_AUTO_TEST_CASE(thread_heap_scope_case)
+{
+	heap& global = memory::get_global_heap();
+	BOOST_CHECK(&memory::get_current_heap() == &global);
+
+	arena_heap arena(&global, memory::single_thread);
+	arena_heap arena2(&global, memory::single_thread);
+	{
+		thread_heap_scope scope(arena);
+		BOOST_CHECK(&memory::get_current_heap() == &arena);
+		BOOST_CHECK(&memory::get_global_heap() == &global);
+		BOOST_CHECK(&abi_allocator<int>().get_heap() == &arena);
+		BOOST_CHECK(&abi_allocator<void>().get_heap() == &arena);
+		BOOST_CHECK(&string("on arena").get_heap() == &arena);
+		BOOST_CHECK(&string().get_heap() == &arena);
+		{
+			thread_heap_scope scope2(arena2);
+			BOOST_CHECK(&memory::get_current_heap() == &arena2);
+			BOOST_CHECK(&string("on arena2").get_heap() == &arena2);
+		}
+		BOOST_CHECK(&memory::get_current_heap() == &arena);
+
+		// other threads are not affected
+		heap* other = 0;
+		std::thread([&other]{ other = &memory::get_current_heap(); }).join();
+		BOOST_CHECK(other == &global);
+
+		// the heap is kept by the objects
+		buffer<int> buf;
+		buf.push_back(1);
+		std::thread([&buf]{ buf.resize(100, 2); }).join();
+		BOOST_CHECK(buf.size() == 100 && buf[99] == 2);
+		BOOST_CHECK(arena.reserved_size() > 0);
+	}
+	BOOST_CHECK(&memory::get_current_heap() == &global);
+	BOOST_CHECK(&string("on global").get_heap() == &global);
+}
 BOOST_AUTO_TEST_SUITE_END()
@@ -5,6 +5,7 @@
 #include <xirang/type/binder.h>
 #include <xirang/type/array.h>
 #include <xirang/type/nativetypeversion.h>
+#include <xirang/io/memory.h>
 
 #include <vector>
 #include <iostream>
@@ -124,4 +125,51 @@ BOOST_AUTO_TEST_CASE(array_case)
 
 }
 
+BOOST_AUTO_TEST_CASE(array_serialize_range_case)
+{
+    Xirang xi("array_serialize_range_case", xirang::memory::get_global_heap(), xirang::memory::get_global_ext_heap());
+
+    SetupXirang(xi);
+    Type int_type = xi.root().findType("int");
+    Type string_type = xi.root().findType("string");
+
+    Array arr1(xi.get_heap(), xi.get_ext_heap(), int_type);
+    arr1.resize(100);
+    for (int i = 0; i < 100; ++i)
+        bind<int>(arr1[i]) = i * 1000 - 7;
+
+    // bulk serialization writes the same bytes as element by element
+    io::mem_archive bulk, single;
+    iref<io::reader, io::writer> ibulk(bulk), isingle(single);
+    int_type.methods().serializeRange(ibulk.get<io::writer>(), *arr1.begin(), arr1.size());
+    for (auto i : arr1)
+        int_type.methods().serialize(isingle.get<io::writer>(), i);
+    BOOST_CHECK(bulk.size() == 100 * sizeof(int32_t));
+    BOOST_CHECK(bulk.data() == single.data());
+
+    Array arr2(xi.get_heap(), xi.get_ext_heap(), int_type);
+    arr2.resize(100);
+    bulk.seek(0);
+    int_type.methods().deserializeRange(ibulk.get<io::reader>(), *arr2.begin(), arr2.size(), xi.get_heap(), xi.get_ext_heap());
+    BOOST_CHECK(arr1 == arr2);
+
+    // non-arithmetic types are serialized one by one
+    Array arr3(xi.get_heap(), xi.get_ext_heap(), string_type);
+    xirang::string str("42");
+    CommonObject obj_str(string_type, &str);
+    for (int i = 0; i < 10; ++i)
+        arr3.push_back(obj_str);
+
+    io::mem_archive strs;
+    iref<io::reader, io::writer> istrs(strs);
+    string_type.methods().serializeRange(istrs.get<io::writer>(), *arr3.begin(), arr3.size());
+
+    Array arr4(xi.get_heap(), xi.get_ext_heap(), string_type);
+    arr4.resize(10);
+    strs.seek(0);
+    string_type.methods().deserializeRange(istrs.get<io::reader>(), *arr4.begin(), arr4.size(), xi.get_heap(), xi.get_ext_heap());
+    BOOST_CHECK(bind<string>(arr4[0]) == str);
+    BOOST_CHECK(bind<string>(arr4[9]) == str);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
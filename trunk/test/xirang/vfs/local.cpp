@@ -1,6 +1,7 @@
 #include "../precompile.h"
 #include <xirang/fsutility.h>
 #include <xirang/vfs/local.h>
+#include <xirang/io/adaptor.h>
 #include "./vfs.h"
 
 BOOST_AUTO_TEST_SUITE(vfs_suite)
@@ -29,6 +30,36 @@ BOOST_AUTO_TEST_CASE(localfs_case)
         BOOST_CHECK(ust.state == fs::st_regular);
         BOOST_CHECK(ust.size == 0);
 
+        // archives created with vo_io_stats count the io
+        local1.setopt(vo_io_stats, any(true));
+        BOOST_CHECK(any_cast<bool>(local1.getopt(vo_io_stats)));
+        {
+            auto ar = local1.create<io::writer, io::options>(file_name, io::of_open);
+            string data("hello");
+            ar.get<io::writer>().write(string_to_c_range(data));
+            auto stats = any_cast<io::io_stats>(ar.get<io::options>().getopt(io::ao_io_stats));
+            BOOST_CHECK(stats.counters[io::io_stats::op_write].calls == 1);
+            BOOST_CHECK(stats.counters[io::io_stats::op_write].bytes == data.size());
+        }
+        {
+            auto ar = local1.create<io::reader, io::options>(file_name, io::of_open);
+            byte buf[8];
+            ar.get<io::reader>().read(make_range(buf, buf + sizeof(buf)));
+            auto stats = any_cast<io::io_stats>(ar.get<io::options>().getopt(io::ao_io_stats));
+            BOOST_CHECK(stats.counters[io::io_stats::op_read].bytes == 5);
+        }
+        local1.setopt(vo_io_stats, any(false));
+    }
+    xirang::fs::recursive_remove(path1);
+
+    path1 = xirang::fs::temp_dir(file_path("localfs"));
+    {
+        LocalFs local1(path1);
+        local1.setopt(vo_io_stats, any(true));
+
+        VfsTester tester;
+        tester.test_on_empty(local1);
+        tester.test_modification(local1);
     }
 	// clean
     xirang::fs::recursive_remove(path1);
@@ -47,3 +47,89 @@ BOOST_AUTO_TEST_CASE(zipfs_case)
 BOOST_AUTO_TEST_SUITE_END()
 
 #endif
+
+#include <xirang/io/memory.h>
+#include <xirang/vfs/zipfs.h>
+#include <xirang/vfs/inmemory.h>
+#include <xirang/zip.h>
+
+//STL
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(vfs_suite)
+BOOST_AUTO_TEST_CASE(zipfs_vector_writer_case)
+{
+	using namespace xirang;
+	using namespace xirang::vfs;
+
+	string text1("quick fox "), text2("jump over the lazy dog");
+	range<const byte*> bufs[] = {
+		make_range((const byte*)text1.data(), (const byte*)text1.data() + text1.size()),
+		make_range((const byte*)text2.data(), (const byte*)text2.data() + text2.size())
+	};
+
+	io::mem_archive ar;
+	{
+		InMemory cache;
+		ZipFs zfs(iref<io::read_map, io::write_map>(ar), &cache);
+		{
+			auto file = create<io::vector_writer>(zfs, sub_file_path(literal("a.txt")), io::of_create);
+			BOOST_CHECK(file.get<io::vector_writer>().writev(make_range(bufs, bufs + 2)) == text1.size() + text2.size());
+		}
+		zfs.sync();
+	}
+	{
+		InMemory cache;
+		ZipFs zfs(iref<io::read_map>(ar), &cache);
+		BOOST_CHECK(zfs.state(sub_file_path(literal("a.txt"))).size == text1.size() + text2.size());
+
+		// no write access to a read only zip file
+		BOOST_CHECK_THROW(create<io::vector_writer>(zfs, sub_file_path(literal("b.txt")), io::of_create), fs::permission_denied_exception);
+	}
+
+	// the committed entry holds both buffers
+	iref<io::read_map, io::write_map> package_ar(ar);
+	zip::reader_writer package(package_ar);
+	auto header = package.get_file(file_path(literal("a.txt")));
+	BOOST_REQUIRE(header != 0);
+	zip::file_header entry = *header;
+	entry.package = &package_ar.get<io::read_map>();
+	auto raw = zip::open_raw(entry);
+	io::mem_archive content;
+	iref<io::write_map> content_map(content);
+	zip::inflate(raw.get<io::read_map>(), content_map.get<io::write_map>());
+	std::string expected = std::string(text1.c_str()) + text2.c_str();
+	BOOST_CHECK_EQUAL(std::string((const char*)content.data().begin(), (const char*)content.data().end()), expected);
+}
+
+BOOST_AUTO_TEST_CASE(zipfs_extract_case)
+{
+	using namespace xirang;
+	using namespace xirang::vfs;
+
+	string text("quick fox jump over the lazy dog");
+	const byte* first = (const byte*)text.data();
+	io::buffer_in src(make_range(first, first + text.size()));
+
+	io::mem_archive ar;
+	{
+		iref<io::read_map, io::write_map> package_ar(ar);
+		zip::reader_writer package(package_ar);
+		iref<io::read_map> src_map(src);
+		BOOST_REQUIRE(package.append(src_map.get<io::read_map>(), file_path(literal("deflated.txt")), zip::cm_deflate));
+		BOOST_REQUIRE(package.append(src_map.get<io::read_map>(), file_path(literal("stored.txt")), zip::cm_store));
+		package.sync();
+	}
+
+	// entries are extracted to the cache with their original content
+	InMemory cache;
+	ZipFs zfs(iref<io::read_map>(ar), &cache);
+	const char* names[] = { "deflated.txt", "stored.txt" };
+	for (auto name : names){
+		auto file = create<io::reader>(zfs, sub_file_path(string(name)), io::of_open);
+		io::mem_archive content;
+		io::copy_data<io::reader, io::writer>(file.get<io::reader>(), content);
+		BOOST_CHECK_EQUAL(std::string((const char*)content.data().begin(), (const char*)content.data().end()), std::string(text.c_str()));
+	}
+}
+BOOST_AUTO_TEST_SUITE_END()
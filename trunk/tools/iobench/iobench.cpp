@@ -0,0 +1,310 @@
+#include <xirang/fsutility.h>
+#include <xirang/io/file.h>
+#include <xirang/io/exchs11n.h>
+#include <xirang/io/parallel_copy.h>
+#include <xirang/versionedvfs.h>
+#include <xirang/vfs/local.h>
+
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+using namespace xirang;
+using std::cout;
+using std::cerr;
+using std::endl;
+
+namespace {
+	typedef std::chrono::steady_clock clock_type;
+
+	long long elapsed_ms(clock_type::time_point start){
+		return std::chrono::duration_cast<std::chrono::milliseconds>(clock_type::now() - start).count();
+	}
+
+	long_size_t arg_size_mb(int argc, char** argv, long_size_t def){
+		return (argc > 0 ? std::strtoull(argv[0], 0, 10) : def) * 1024 * 1024;
+	}
+
+	file_path make_data_file(const file_path& dir, long_size_t size){
+		file_path path = dir / file_path(literal("data"));
+		io::file wr(path, io::of_create_or_open);
+		buffer<byte> buf;
+		buf.resize(64 * 1024, byte(0x5a));
+		for (long_size_t i = 0; i < size; i += buf.size())
+			wr.write(make_range(buf.begin(), buf.begin() + std::min<long_size_t>(buf.size(), size - i)));
+		return path;
+	}
+
+	/// load the whole file as uint32_t scalars, like index loading does.
+	void load_scalars(io::file_reader& rd, const char* title){
+		auto start = clock_type::now();
+		auto map_count = any_cast<long_size_t>(rd.getopt(io::ao_map_count));
+
+		rd.seek(0);
+		auto source = io::exchange::as_source(rd);
+		uint32_t sum = 0;
+		while (rd.readable())
+			sum += io::load<uint32_t>(source);
+
+		cout << title << ":\t" << elapsed_ms(start) << " ms\t"
+			<< (any_cast<long_size_t>(rd.getopt(io::ao_map_count)) - map_count) << " mappings\t"
+			<< "(checksum " << sum << ")" << endl;
+	}
+}
+
+void cmd_map_window(int argc, char** argv){
+	long_size_t size = arg_size_mb(argc, argv, 4);
+	file_path dir = fs::temp_dir(file_path(literal("iobench")));
+	{
+		io::file_reader rd(make_data_file(dir, size));
+		load_scalars(rd, "cached windows");
+
+		rd.setopt(io::ao_map_window_count, std::size_t(0));
+		load_scalars(rd, "map per read");
+	}
+	fs::recursive_remove(dir);
+}
+
+namespace {
+	/// sequential write then read by 4KB blocks.
+	void stream_file(const file_path& path, long_size_t size, int of, const char* title){
+		buffer<byte> buf;
+		buf.resize(4 * 1024, byte(0x5a));
+
+		auto start = clock_type::now();
+		{
+			io::file wr(path, of | io::of_create_or_open);
+			for (long_size_t i = 0; i < size; i += buf.size())
+				wr.write(to_range(buf));
+		}
+		auto write_ms = elapsed_ms(start);
+
+		start = clock_type::now();
+		long_size_t sum = 0;
+		{
+			io::file_reader rd(path, of);
+			while (rd.readable()){
+				rd.read(to_range(buf));
+				sum += static_cast<unsigned char>(buf[0]);
+			}
+		}
+		cout << title << ":\twrite " << write_ms << " ms\tread " << elapsed_ms(start) << " ms"
+			<< "\t(checksum " << sum << ")" << endl;
+		fs::remove(path);
+	}
+}
+
+void cmd_stream(int argc, char** argv){
+	long_size_t size = arg_size_mb(argc, argv, 256);
+	file_path dir = fs::temp_dir(file_path(literal("iobench")));
+	file_path path = dir / file_path(literal("data"));
+
+	stream_file(path, size, 0, "mapped");
+	stream_file(path, size, io::of_stream_io, "stream io");
+	fs::recursive_remove(dir);
+}
+
+namespace {
+	/// read 4KB blocks at random offsets, keep at most depth requests in flight.
+	/// the page cache of the file is dropped first if possible.
+	void random_read(const file_path& path, std::size_t count, std::size_t depth, const char* title){
+		const std::size_t K_Block = 4 * 1024;
+		io::file_reader rd(path);
+		rd.setopt(io::ao_access_hint, io::ah_dontneed);
+		rd.setopt(io::ao_access_hint, io::ah_random);
+
+		long_size_t blocks = rd.size() / K_Block;
+		buffer<byte> buf;
+		buf.resize(K_Block * depth);
+		std::vector<io::async_result> results(depth);
+
+		std::srand(42);
+		auto start = clock_type::now();
+		long_size_t sum = 0;
+		for (std::size_t i = 0; i < count; ++i){
+			std::size_t slot = i % depth;
+			byte* first = buf.begin() + slot * K_Block;
+			long_size_t off = (long_size_t(std::rand()) % blocks) * K_Block;
+			if (depth == 1){
+				rd.read_at(off, make_range(first, first + K_Block));
+				sum += static_cast<unsigned char>(first[0]);
+			}
+			else{
+				if (results[slot].valid()){
+					results[slot].get();
+					sum += static_cast<unsigned char>(first[0]);
+				}
+				results[slot] = rd.async_read(off, make_range(first, first + K_Block));
+			}
+		}
+		for (std::size_t slot = 0; slot < depth; ++slot){
+			if (results[slot].valid()){
+				results[slot].get();
+				sum += static_cast<unsigned char>(buf[slot * K_Block]);
+			}
+		}
+		cout << title << ":	" << elapsed_ms(start) << " ms	(checksum " << sum << ")" << endl;
+	}
+}
+
+void cmd_async(int argc, char** argv){
+	long_size_t size = arg_size_mb(argc, argv, 256);
+	file_path dir = fs::temp_dir(file_path(literal("iobench")));
+	file_path path = make_data_file(dir, size);
+
+	random_read(path, 20000, 1, "read_at");
+	random_read(path, 20000, 64, "async_read x64");
+	fs::recursive_remove(dir);
+}
+
+namespace {
+	/// copy src to a new file by read_map and write_map views
+	void view_copy(const file_path& dir, const file_path& src, int of, const io::view_options& opts, const char* title){
+		file_path dest = dir / file_path(literal("copy"));
+		auto start = clock_type::now();
+		{
+			io::file_reader rd(src, of);
+			io::file wr(dest, of | io::of_create_or_open);
+			iref<io::read_map> rmap(rd);
+			iref<io::write_map> wmap(wr);
+			io::copy_data(rmap.get<io::read_map>(), wmap.get<io::write_map>(), ~0, opts);
+		}
+		cout << title << ":\t" << elapsed_ms(start) << " ms" << endl;
+		fs::remove(dest);
+	}
+
+	/// same as view_copy, by copy_data_parallel
+	void parallel_copy(const file_path& dir, const file_path& src, const io::parallel_copy_options& opts, const char* title){
+		file_path dest = dir / file_path(literal("copy"));
+		auto start = clock_type::now();
+		{
+			io::file_reader rd(src);
+			io::file wr(dest, io::of_create_or_open);
+			iref<io::read_map> rmap(rd);
+			iref<io::write_map> wmap(wr);
+			io::copy_data_parallel(rmap.get<io::read_map>(), wmap.get<io::write_map>(), ~0, opts);
+		}
+		cout << title << ":\t" << elapsed_ms(start) << " ms" << endl;
+		fs::remove(dest);
+	}
+}
+
+/// argument is the size of the largest copy in MB, 4KB and 1MB copies are always measured.
+void cmd_view_copy(int argc, char** argv){
+	long_size_t sizes[] = { 4 * 1024, 1024 * 1024, arg_size_mb(argc, argv, 4096) };
+	io::view_options fixed;
+	fixed.max_size = fixed.initial_size;
+
+	for (auto size : sizes){
+		file_path dir = fs::temp_dir(file_path(literal("iobench")));
+		file_path src = make_data_file(dir, size);
+		cout << "copy " << size / 1024 << " KB" << endl;
+		view_copy(dir, src, 0, fixed, "  fixed 64KB views");
+		view_copy(dir, src, 0, io::view_options(), "  adaptive views");
+		view_copy(dir, src, io::of_map_populate, io::view_options(), "  adaptive populated views");
+		view_copy(dir, src, io::of_map_populate | io::of_map_hugepage, io::view_options(), "  adaptive hugepage views");
+
+		io::parallel_copy_options popts;
+		popts.min_size = 0;
+		parallel_copy(dir, src, popts, "  parallel");
+		popts.checksum = io::ck_crc32;
+		parallel_copy(dir, src, popts, "  parallel with crc32");
+		fs::recursive_remove(dir);
+	}
+}
+
+/// time getFileVersion of files in a committed tree of 16 x 16 directories with 16 files each.
+void cmd_repo_lookup(int argc, char** argv){
+	int lookups = argc > 0 ? std::atoi(argv[0]) : 100000;
+	const int fanout = 16;
+	file_path dir = fs::temp_dir(file_path(literal("iobench")));
+	file_path repo_dir = dir / file_path(literal("repo"));
+	file_path stage_dir = dir / file_path(literal("stage"));
+	fs::create_dir(repo_dir);
+	fs::create_dir(stage_dir);
+
+	std::vector<file_path> paths;
+	{
+		vfs::LocalFs rootfs(dir);
+		vfs::initRepository(rootfs, sub_file_path(literal("repo")));
+
+		vfs::LocalFs wkfs(stage_dir);
+		for (int i = 0; i < fanout; ++i){
+			file_path d1(string(std::to_string(i).c_str()));
+			wkfs.createDir(d1);
+			for (int j = 0; j < fanout; ++j){
+				file_path d2 = d1 / file_path(string(std::to_string(j).c_str()));
+				wkfs.createDir(d2);
+				for (int k = 0; k < fanout; ++k){
+					file_path f = d2 / file_path(string(("f" + std::to_string(k)).c_str()));
+					auto wr = wkfs.create<io::writer>(f, io::of_create);
+					auto first = reinterpret_cast<const byte*>(f.str().c_str());
+					wr.get<io::writer>().write(make_range(first, first + f.str().size()));
+					paths.push_back(f);
+				}
+			}
+		}
+
+		vfs::Workspace wk(wkfs, string());
+		vfs::LocalFs rpfs(repo_dir);
+		vfs::LocalRepository repo(rpfs, file_path());
+		repo.commit(wk, string("bench"), version_type());
+	}
+
+	vfs::LocalFs rpfs(repo_dir);
+	vfs::LocalRepository repo(rpfs, file_path());
+	auto head = repo.getSubmission(version_type()).version;
+
+	auto start = clock_type::now();
+	int found = 0;
+	for (int i = 0; i < lookups; ++i){
+		if (!is_empty(repo.getFileVersion(head, paths[i % paths.size()])))
+			++found;
+	}
+	cout << lookups << " lookups:\t" << elapsed_ms(start) << " ms\t(" << found << " found)" << endl;
+	fs::recursive_remove(dir);
+}
+
+typedef std::function<void(int, char**)> command_type;
+std::unordered_map<std::string, command_type> command_table = {
+	{std::string("map_window"), cmd_map_window},
+	{std::string("stream"), cmd_stream},
+	{std::string("async"), cmd_async},
+	{std::string("view_copy"), cmd_view_copy},
+	{std::string("repo_lookup"), cmd_repo_lookup}
+};
+
+void print_help(){
+	cout << "command list:\n";
+	for (auto& i : command_table){
+			cout << i.first << endl;
+	}
+}
+int do_main(int argc, char** argv){
+	if (argc < 2){
+		print_help();
+		return 1;
+	}
+
+	std::string command(argv[1]);
+
+	auto pos = command_table.find(command);
+	if (pos == command_table.end()){
+		print_help();
+		return 1;
+	}
+
+	pos->second(argc - 2, argv + 2);
+	return 0;
+}
+
+int main(int argc, char** argv){
+	try{
+		return do_main(argc, argv);
+	}catch(exception& e){
+		cerr << e.what() << endl;
+	}
+}
@@ -38,7 +38,7 @@ namespace xirang
 
 		///\post empty()
 		buffer()
-			: m_heap(&memory::get_global_heap())
+			: m_heap(&memory::get_current_heap())
 			, m_capacity(0)
 			, m_size(0)
 			, m_data(0)
@@ -93,7 +93,7 @@ namespace xirang
 			}
 		}
 
-		buffer(size_type count, T ch, heap& h = memory::get_global_heap())
+		buffer(size_type count, T ch, heap& h = memory::get_current_heap())
 			: m_heap(&h)
 			, m_capacity(0)
 			, m_size(count)
@@ -107,7 +107,7 @@ namespace xirang
 			}
 		}
 		template<typename Range>
-		buffer(const Range& r, heap& h = memory::get_global_heap())
+		buffer(const Range& r, heap& h = memory::get_current_heap())
 			: m_heap(&h)
 			, m_capacity(0)
 			, m_size(0)
@@ -23,7 +23,7 @@ namespace xirang{
 		template<typename T, std::size_t N> 
 			struct convert_imp<big_endian_tag, little_endian_tag, T, N>{ 
 				static T apply(T t){
-					return convert_imp<little_endian_tag, big_endian_tag, T, N>(t);
+					return convert_imp<little_endian_tag, big_endian_tag, T, N>::apply(t);
 				}
 			};
 
@@ -39,6 +39,15 @@ namespace xirang{
 				return convert_imp<From, To, T, sizeof(T)>::apply(t);
 			}
 
+		/// convert [first, last) to dest, dest can be first to convert in place.
+		/// \return the end of dest
+		template<typename From, typename To, typename T>
+			T* convert_range(const T* first, const T* last, T* dest){
+				for (; first != last; ++first, ++dest)
+					*dest = convert_imp<From, To, T, sizeof(T)>::apply(*first);
+				return dest;
+			}
+
 		template<typename T> T little2big(T t){
 			return convert<little_endian_tag, big_endian_tag>(t);
 		}
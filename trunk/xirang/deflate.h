@@ -62,6 +62,14 @@ namespace xirang{ namespace zip{
 	extern zip_result deflate(io::reader& src, io::writer& dest, zip_format format = zm_raw_deflate, int level = zl_default, dict_type dict = dict_type(),heap* h = 0, int strategy_ = zs_default);
 	extern zip_result deflate(io::read_map& src, io::write_map& dest, zip_format format = zm_raw_deflate, int level = zl_default, dict_type dict = dict_type(),  heap* h = 0, int strategy_ = zs_default);
 
+	/// same as inflate(io::reader&, io::writer&, ...), but the decompression runs on a worker thread
+	/// by io::copy_data_pipelined, overlapping with the writing of dest. worth it for large streams only.
+	/// \note h is used by the worker thread, it must be a thread safe heap.
+	extern zip_result inflate_pipelined(io::reader& src, io::writer& dest, zip_format format = zm_raw_deflate, dict_type dict = dict_type(),heap* h = 0);
+	/// same as deflate(io::reader&, io::writer&, ...), but src is read by a worker thread by io::copy_data_pipelined,
+	/// overlapping with the compression. worth it for large and slow sources only.
+	extern zip_result deflate_pipelined(io::reader& src, io::writer& dest, zip_format format = zm_raw_deflate, int level = zl_default, dict_type dict = dict_type(),heap* h = 0, int strategy_ = zs_default);
+
 	// imp reader, forward
 	class inflate_reader_imp;
 	class inflate_reader{
@@ -30,21 +30,94 @@ namespace xirang
 
 	};
 
+	struct pool_heap_imp;
+
+	/// size class segregated pool. small blocks are carved from 64KB slabs allocated from the underling heap,
+	/// each size class keeps its own free list. larger blocks are forwarded to the underling heap.
+	/// in multi_thread mode, each thread caches some free blocks per size class, so most malloc and free
+	/// calls don't take any lock.
+	/// the slabs are kept by the pool until it's destroyed, all small blocks are released together then.
 	struct AIO_COMM_API pool_heap : heap
 	{
+		/// ctor
+		/// \param under the heap provides slabs and large blocks
+		/// \param thp if it's single_thread, the pool must be used by one thread at a time, no lock and thread cache.
+		/// \pre under != 0
 		explicit pool_heap(heap* under, memory::thread_policy thp);
+
+		/// release all slabs to the underling heap. large blocks still allocated are not released.
 		virtual ~pool_heap();
 
+		/// \note alignment up to 4KB is supported by small blocks, blocks with larger alignment are large blocks.
 		virtual void* malloc(std::size_t size, std::size_t alignment, const void* hint);
+
+		/// the size is used to find small or large blocks directly. if it's 0, the slabs are searched.
+		/// \pre blocks with alignment larger than 4KB should be freed with their alignment or zero size.
 		virtual void free(void* p, std::size_t size, std::size_t alignment);
+
+		/// return the heap passed to ctor.
 		virtual heap* underling();
 
+		/// equal to itself only.
 		virtual bool equal_to(const heap& rhs) const;
 
+		/// stop the thread caches, and return the blocks cached by current thread.
+		/// the blocks cached by other threads are kept until the pool is destroyed,
+		/// so it should be called when other threads don't use the pool anymore. dtor calls it too.
 		virtual void prepare_destroy();
+
+		pool_heap(const pool_heap&) = delete;
+		pool_heap& operator=(const pool_heap&) = delete;
+	private:
+		pool_heap_imp* m_imp;
 	};
 
+	struct arena_heap_imp;
+
+	/// monotonic heap. blocks are bumped from chunks allocated from the underling heap, each chunk is
+	/// double size of the previous one up to 1MB. free does nothing, all blocks are released together
+	/// by reset, release_all or dtor. it fits the temporary objects which are destroyed together.
+	/// blocks larger than a quarter of the first chunk are allocated from the underling heap directly,
+	/// they are released by free if the size is passed.
+	struct AIO_COMM_API arena_heap : heap
+	{
+		/// ctor
+		/// \param under the heap provides chunks and oversized blocks
+		/// \param thp if it's multi_thread, malloc is serialized by a lock.
+		/// \param chunk_size size of the first chunk
+		/// \pre under != 0 && chunk_size >= 64
+		explicit arena_heap(heap* under, memory::thread_policy thp, std::size_t chunk_size = 64 * 1024);
+
+		/// release all blocks
+		virtual ~arena_heap();
+
+		virtual void* malloc(std::size_t size, std::size_t alignment, const void* hint);
+
+		/// do nothing except for oversized blocks, which are released if size is not zero.
+		virtual void free(void* p, std::size_t size, std::size_t alignment);
+
+		/// return the heap passed to ctor.
+		virtual heap* underling();
+
+		/// equal to itself only.
+		virtual bool equal_to(const heap& rhs) const;
+
+		/// release all blocks, but keep the last chunk for reuse.
+		/// \pre no block allocated from this heap is in use.
+		void reset();
+
+		/// release all blocks and chunks to the underling heap.
+		/// \pre no block allocated from this heap is in use.
+		void release_all();
 
+		/// \return bytes held from the underling heap, include chunks and oversized blocks.
+		std::size_t reserved_size() const;
+
+		arena_heap(const arena_heap&) = delete;
+		arena_heap& operator=(const arena_heap&) = delete;
+	private:
+		arena_heap_imp* m_imp;
+	};
 }
 
 #endif //end AIO_COMMON_HEAP_H
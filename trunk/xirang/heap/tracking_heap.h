@@ -0,0 +1,117 @@
+#ifndef AIO_COMMON_UTILITY_TRACKING_HEAP_H
+#define AIO_COMMON_UTILITY_TRACKING_HEAP_H
+
+#include <xirang/memory.h>
+#include <xirang/string.h>
+
+//STL
+#include <vector>
+
+namespace xirang
+{
+	/// count of size bins, bin i counts the blocks of size in (2^(i-1), 2^i], the last one counts all larger blocks.
+	const std::size_t K_heap_histogram_bins = 40;
+
+	/// statistics of the blocks allocated by current tag
+	struct heap_tag_statistics
+	{
+		const char* tag;		///< null for untagged blocks
+		long_size_t live_bytes;
+		long_size_t live_blocks;
+		long_size_t total_allocs;
+		long_size_t total_bytes;
+	};
+
+	struct heap_statistics
+	{
+		long_size_t live_bytes;
+		long_size_t live_blocks;
+		long_size_t peak_bytes;		///< high-water mark of live_bytes
+		long_size_t peak_blocks;	///< high-water mark of live_blocks
+
+		long_size_t total_allocs;
+		long_size_t total_frees;
+		long_size_t total_bytes;	///< bytes of all allocations
+		/// frees with unknown size, their bytes are not subtracted from live_bytes unless tags are tracked.
+		long_size_t unsized_frees;
+
+		double seconds;				///< since the heap is created
+		long_size_t histogram[K_heap_histogram_bins];
+
+		/// empty if AIO_HEAP_TRACKING_TAGS is not defined
+		std::vector<heap_tag_statistics> tags;
+
+		/// \return allocations per second
+		double alloc_rate() const { return seconds > 0 ? total_allocs / seconds : 0;}
+	};
+
+	/// human readable statistics
+	AIO_COMM_API extern string format_text(const heap_statistics& stat);
+	/// statistics as a json object
+	AIO_COMM_API extern string format_json(const heap_statistics& stat);
+
+	struct tracking_heap_imp;
+
+	/// record the statistics of blocks, forward malloc and free to the underling heap.
+	/// replace the global heap by a tracking heap over it to find out who holds the memory.
+	/// if AIO_HEAP_TRACKING_TAGS is defined, each block is recorded with the tag of heap_tag_scope in current thread,
+	/// and the statistics of each tag are collected.
+	struct AIO_COMM_API tracking_heap : heap
+	{
+		/// \pre under != 0
+		explicit tracking_heap(heap* under);
+		virtual ~tracking_heap();
+
+		virtual void* malloc(std::size_t size, std::size_t alignment, const void* hint);
+		virtual void free(void* p, std::size_t size, std::size_t alignment);
+
+		/// return the heap passed to ctor.
+		virtual heap* underling();
+
+		/// equal to itself only.
+		virtual bool equal_to(const heap& rhs) const;
+
+		/// \return current statistics
+		heap_statistics snapshot() const;
+
+		/// restart the high-water marks from current live bytes and blocks.
+		void reset_peak();
+
+		tracking_heap(const tracking_heap&) = delete;
+		tracking_heap& operator=(const tracking_heap&) = delete;
+	private:
+		tracking_heap_imp* m_imp;
+	};
+
+#ifdef AIO_HEAP_TRACKING_TAGS
+	/// set the tag of the blocks allocated by current thread in the scope, scopes can be nested.
+	class AIO_COMM_API heap_tag_scope
+	{
+	public:
+		/// \pre tag should be a literal, or live longer than the tracking heaps.
+		explicit heap_tag_scope(const char* tag);
+		~heap_tag_scope();
+
+		/// \return tag of current thread, null if there is no scope.
+		static const char* current();
+
+		heap_tag_scope(const heap_tag_scope&) = delete;
+		heap_tag_scope& operator=(const heap_tag_scope&) = delete;
+	private:
+		const char* m_saved;
+	};
+#else
+	/// tags are not tracked
+	class heap_tag_scope
+	{
+	public:
+		explicit heap_tag_scope(const char* ){}
+		static const char* current() { return 0;}
+
+		heap_tag_scope(const heap_tag_scope&) = delete;
+		heap_tag_scope& operator=(const heap_tag_scope&) = delete;
+	};
+#endif
+}
+
+#endif //end AIO_COMMON_UTILITY_TRACKING_HEAP_H
@@ -12,6 +12,10 @@
 #include <xirang/memory.h>
 #include <xirang/any.h>
 #include <xirang/interface.h>
+
+// STD
+#include <future>
+
 namespace xirang { namespace io{
 	namespace private_{
 		template<typename ...T> struct total_size_of;
@@ -52,7 +56,56 @@ namespace xirang { namespace io{
         of_low_mask = 0xffff,
 
         /// depends on implementation capability. intends to be used to create a tempfile
-        of_remove_on_close = 1 << 16    ///< remove archive on close.     
+        of_remove_on_close = 1 << 16,    ///< remove archive on close.     
+
+        /// depends on implementation capability. intends to be used by archives appended frequently.
+        /// the physical size may be greater than size() until sync or close.
+        of_preallocate = 1 << 17,       ///< grow archive capacity geometrically on append.
+
+        /// initial sync policy, see sync_policy and ao_sync_policy
+        of_sync_async = 1 << 18,        ///< sync() schedules write back, don't wait.
+        of_sync_durable = 1 << 19,      ///< sync() returns after data reach the storage.
+
+        /// depends on implementation capability. use plain read/write calls instead of memory mapping,
+        /// intends to be used by large sequential streams.
+        of_stream_io = 1 << 20,
+
+        /// initial access hint, see access_hint and ao_access_hint. at most one of them should be set.
+        of_access_sequential = 1 << 21,	///< scanned from begin to end
+        of_access_random = 1 << 22,		///< probed randomly, read ahead is useless
+        of_access_willneed = 1 << 23,	///< will be accessed soon, prefetch it
+        of_access_dontneed = 1 << 24,	///< won't be accessed soon, cached data can be dropped
+        of_access_mask = of_access_sequential | of_access_random | of_access_willneed | of_access_dontneed,
+
+        /// depends on implementation capability. written data bypass the page cache (O_DIRECT), implies of_stream_io.
+        /// intends to be used by large archives written once, to avoid evicting the hot data of readers.
+        of_direct_io = 1 << 25,
+
+        /// depends on implementation capability. mapped views are prefaulted when created (MAP_POPULATE).
+        of_map_populate = 1 << 26,
+        /// depends on implementation capability. mapped views are backed by huge pages if the file system supports.
+        of_map_hugepage = 1 << 27
+	};
+
+	/// how an archive will be accessed, depends on implementation capability. it doesn't change the semantic.
+	enum access_hint
+	{
+		ah_normal,		///< no hint
+		ah_sequential,	///< see of_access_sequential
+		ah_random,		///< see of_access_random
+		ah_willneed,	///< see of_access_willneed
+		ah_dontneed		///< see of_access_dontneed
+	};
+
+	/// \return the access hint carried by open flag of, ah_normal if none.
+	extern access_hint access_hint_of(int of);
+
+	/// how writer::sync flushes the written data, depends on implementation capability.
+	enum sync_policy
+	{
+		sp_none,	///< no flush, leave it to OS
+		sp_async,	///< start write back of dirty range, don't wait
+		sp_durable	///< wait until the dirty data reach the storage
 	};
 
 	/// option id
@@ -60,6 +113,14 @@ namespace xirang { namespace io{
     {
         ao_default = 0,
 
+        ao_map_window_size,     ///< std::size_t, size of each cached mapping window, rounded up to page size
+        ao_map_window_count,    ///< std::size_t, max count of cached mapping windows, 0 disables the cache
+        ao_map_count,           ///< long_size_t, readonly, count of mappings created by the archive
+        ao_sync_policy,         ///< sync_policy, how sync() flushes written data
+        ao_access_hint,         ///< access_hint, setopt indata is an optional ext_heap::handle to limit the advised range
+        ao_direct_io,           ///< bool, readonly, whether written data bypass the page cache, see of_direct_io
+        ao_io_stats,            ///< io_stats of stats_archive, setopt resets the counters
+
         ao_user = 1 << 16
     };
 
@@ -91,6 +152,48 @@ namespace xirang { namespace io{
 	template<typename CoClass>
 	reader_co<CoClass> get_interface_map(reader*, CoClass*);
 
+	//positional_reader
+	struct AIO_INTERFACE positional_reader
+	{
+		typedef byte* iterator;
+
+		/// read at given offset, the offset of archive is not changed.
+		/// concurrent calls are safe if no other operation modifies the archive at the same time.
+		/// \param buf should be memory continuous
+		/// \return return rest part of given buf
+		virtual range<iterator> read_at(long_size_t off, const range<iterator>& buf) const = 0;
+
+		virtual ~positional_reader();
+	};
+	template<typename CoClass> struct positional_reader_co : public positional_reader
+	{
+		virtual range<iterator> read_at(long_size_t off, const range<iterator>& buf) const{
+			return get_cobj<CoClass>(this).read_at(off, buf);
+		}
+	};
+	template<typename CoClass>
+	positional_reader_co<CoClass> get_interface_map(positional_reader*, CoClass*);
+
+	//vector_reader
+	struct AIO_INTERFACE vector_reader
+	{
+		typedef byte* iterator;
+
+		/// scatter read, same as read into the concatenation of bufs
+		/// \return bytes read, less than the total size of bufs only if reach the end of archive
+		virtual long_size_t readv(const range<const range<iterator>*>& bufs) = 0;
+
+		virtual ~vector_reader();
+	};
+	template<typename CoClass> struct vector_reader_co : public vector_reader
+	{
+		virtual long_size_t readv(const range<const range<iterator>*>& bufs){
+			return get_cobj<CoClass>(this).readv(bufs);
+		}
+	};
+	template<typename CoClass>
+	vector_reader_co<CoClass> get_interface_map(vector_reader*, CoClass*);
+
 	//writer
 	struct AIO_INTERFACE writer
 	{
@@ -122,6 +225,26 @@ namespace xirang { namespace io{
 	template<typename CoClass>
 	writer_co<CoClass> get_interface_map(writer*, CoClass*);
 
+	//vector_writer
+	struct AIO_INTERFACE vector_writer
+	{
+		typedef const byte* const_iterator;
+
+		/// gather write, same as write the concatenation of bufs
+		/// \return bytes written, less than the total size of bufs only if archive is not writable
+		virtual long_size_t writev(const range<const range<const_iterator>*>& bufs) = 0;
+
+		virtual ~vector_writer();
+	};
+	template<typename CoClass> struct vector_writer_co : public vector_writer
+	{
+		virtual long_size_t writev(const range<const range<const_iterator>*>& bufs){
+			return get_cobj<CoClass>(this).writev(bufs);
+		}
+	};
+	template<typename CoClass>
+	vector_writer_co<CoClass> get_interface_map(vector_writer*, CoClass*);
+
 	//ioctrl
 	struct AIO_INTERFACE ioctrl{
 		/// set archive length with given size
@@ -236,7 +359,7 @@ namespace xirang { namespace io{
 	};
 	template<typename CoClass> struct options_co : public options
 	{
-		virtual any getopt(int id, const any & optdata){
+		virtual any getopt(int id, const any & optdata) const{
 			return get_cobj<CoClass>(this).getopt(id, optdata);
 		}
 		virtual any setopt(int id, const any & optdata,  const any & indata){
@@ -348,6 +471,83 @@ namespace xirang { namespace io{
 	template<typename CoClass>
 	write_map_co<CoClass> get_interface_map(write_map*, CoClass*);
 
+#ifdef WIN32
+	typedef void* native_handle_t;
+#else
+	typedef int native_handle_t;
+#endif
+
+	//native_handle
+	struct AIO_INTERFACE native_handle
+	{
+		/// flush the user space buffer of archive, then the file can be accessed via the returned handle directly.
+		/// \note the position of handle is unspecified, use positional calls only.
+		virtual native_handle_t handle() = 0;
+
+		/// tell the archive [first, last) of the file was written via handle directly.
+		virtual void handle_written(long_size_t first, long_size_t last) = 0;
+
+		virtual ~native_handle();
+	};
+	template<typename CoClass> struct native_handle_co : public native_handle
+	{
+		virtual native_handle_t handle(){
+			return get_cobj<CoClass>(this).handle();
+		}
+		virtual void handle_written(long_size_t first, long_size_t last){
+			get_cobj<CoClass>(this).handle_written(first, last);
+		}
+	};
+	template<typename CoClass>
+	native_handle_co<CoClass> get_interface_map(native_handle*, CoClass*);
+
+	/// completion of an asynchronous request, get() returns the transferred bytes or rethrows the error.
+	typedef std::future<long_size_t> async_result;
+
+	//async_reader
+	struct AIO_INTERFACE async_reader
+	{
+		typedef byte* iterator;
+
+		/// submit a read at given offset and return at once, the offset of archive is not changed.
+		/// many requests can be in flight, they may complete in any order.
+		/// \param buf should be memory continuous, and alive until the request completes
+		/// \return the bytes read will be less than buf.size() only if reach the end of archive.
+		virtual async_result async_read(long_size_t off, const range<iterator>& buf) = 0;
+
+		virtual ~async_reader();
+	};
+	template<typename CoClass> struct async_reader_co : public async_reader
+	{
+		virtual async_result async_read(long_size_t off, const range<iterator>& buf){
+			return get_cobj<CoClass>(this).async_read(off, buf);
+		}
+	};
+	template<typename CoClass>
+	async_reader_co<CoClass> get_interface_map(async_reader*, CoClass*);
+
+	//async_writer
+	struct AIO_INTERFACE async_writer
+	{
+		typedef const byte* const_iterator;
+
+		/// submit a write at given offset and return at once, the offset of archive is not changed.
+		/// the size of archive is extended at submission. overlapped requests in flight have unspecified result.
+		/// \note writer::sync doesn't wait for the requests in flight.
+		/// \param buf should be memory continuous, and alive until the request completes
+		virtual async_result async_write(long_size_t off, const range<const_iterator>& buf) = 0;
+
+		virtual ~async_writer();
+	};
+	template<typename CoClass> struct async_writer_co : public async_writer
+	{
+		virtual async_result async_write(long_size_t off, const range<const_iterator>& buf){
+			return get_cobj<CoClass>(this).async_write(off, buf);
+		}
+	};
+	template<typename CoClass>
+	async_writer_co<CoClass> get_interface_map(async_writer*, CoClass*);
+
 
 	/// read full buf or reach the end of rd
 	/// \return rest part of given buf
@@ -373,9 +573,44 @@ namespace xirang { namespace io{
 	/// \return the real copies bytes
 	extern long_size_t copy_data(reader& rd, writer& wr, long_size_t max_size  = ~0 );
 
-	extern long_size_t copy_data(reader& rd, write_map& wr, long_size_t max_size  = ~0 );
-	extern long_size_t copy_data(read_map& rd, writer& wr, long_size_t max_size  = ~0 );
-	extern long_size_t copy_data(read_map& rd, write_map& wr, long_size_t max_size  = ~0 );
+	/// sizes of the views created by copy_data with read_map or write_map.
+	/// the first view is initial_size, then the size doubles up to max_size, so large copies need few mappings.
+	/// both are rounded up to the allocation granularity, 64KB.
+	struct view_options
+	{
+		view_options() : initial_size(64 * 1024), max_size(64 * 1024 * 1024){}
+
+		long_size_t initial_size;
+		long_size_t max_size;
+	};
+
+	extern long_size_t copy_data(reader& rd, write_map& wr, long_size_t max_size  = ~0, const view_options& opts = view_options());
+	extern long_size_t copy_data(read_map& rd, writer& wr, long_size_t max_size  = ~0, const view_options& opts = view_options());
+	extern long_size_t copy_data(read_map& rd, write_map& wr, long_size_t max_size  = ~0, const view_options& opts = view_options());
+
+	/// copy from the current offset of rd to the current offset of wr, both offsets are advanced.
+	/// data is copied by kernel (reflink, copy_file_range or sendfile) if supported,
+	/// otherwise or the rest part falls back to copy_data(reader&, writer&).
+	/// \return the real copies bytes
+	extern long_size_t copy_data(const iref<reader, random, native_handle>& rd,
+			const iref<writer, random, native_handle>& wr, long_size_t max_size  = ~0 );
+
+	struct pipeline_options
+	{
+		pipeline_options() : buffer_size(64 * 1024), buffer_count(4){}
+
+		std::size_t buffer_size;	///< size of each buffer
+		std::size_t buffer_count;	///< count of buffers in the ring, at least 2
+	};
+
+	/// same as copy_data(rd, wr, max_size), but rd is read by a worker thread while wr is written in current thread,
+	/// intends to overlap a slow reader and a slow writer, e.g. inflate_reader and file writer.
+	/// the exception thrown by rd is rethrown in current thread.
+	/// \note rd must not be accessed by others during the copy. it allocates from the heaps of the worker thread,
+	/// which ignores the thread_heap_scope of current thread, so the heaps must be thread safe.
+	/// spawning a thread per call is not worth it for small copies, copy_data is the default choice.
+	extern long_size_t copy_data_pipelined(reader& rd, writer& wr, long_size_t max_size  = ~0,
+			const pipeline_options& opts = pipeline_options());
 
 	template<typename Input, typename Output, typename InAr, typename OutAr>
 	long_size_t copy_data(InAr& rd, OutAr& wr, long_size_t max_size  = ~0 ){
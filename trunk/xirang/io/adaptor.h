@@ -4,6 +4,11 @@
 #include <xirang/io.h>
 #include <xirang/io/memory.h>
 
+// STD
+#include <vector>
+#include <chrono>
+#include <atomic>
+
 namespace xirang{ namespace io{
 	namespace io_private_{
 		template<typename Interface, typename Archive> typename std::enable_if<!is_iref<Archive>::value, Archive&>::type get_i_(Archive& ar){
@@ -30,11 +35,35 @@ namespace xirang{ namespace io{
 		template<typename Interface, typename ...Interfaces> Interface& get_i_(const iref<Interfaces...>* ar){
 			return ar->template get<Interface>();
 		}
+
+		/// keep the leading limit bytes of bufs
+		/// \return false if bufs is not longer than limit, and clipped is untouched
+		template<typename Iterator> bool clip_ranges_(const range<const range<Iterator>*>& bufs,
+				long_size_t limit, std::vector<range<Iterator>>& clipped){
+			long_size_t total = 0;
+			for (auto& i : bufs)
+				total += i.size();
+			if (total <= limit)
+				return false;
+
+			for (auto& i : bufs){
+				if (limit == 0)
+					break;
+				auto size = std::min<long_size_t>(i.size(), limit);
+				clipped.push_back(range<Iterator>(i.begin(), i.begin() + size));
+				limit -= size;
+			}
+			return true;
+		}
 		template<typename Interface, typename ...Interfaces> Interface& get_i_(const iauto<Interfaces...>* ar){
 			return ar->template get<Interface>();
 		}
 	}
 
+	/// called by ~decorator while the decorator is still complete, ArchiveData which has pending work to do
+	/// before destruction overloads it, e.g. buffered_archive writes back the pending data.
+	template<typename Derive, typename ArchiveData> void decorator_finalize(Derive& , ArchiveData* ){}
+
 	template<typename ArchiveData, template<typename> class ... PartialInterfaces>
 		struct decorator : public ArchiveData,
 		public PartialInterfaces<decorator<ArchiveData, PartialInterfaces...> >...
@@ -43,6 +72,14 @@ namespace xirang{ namespace io{
 		template<typename ... Args>
 		explicit decorator(Args&& ... args) : ArchiveData(std::forward<Args>(args)...){}
 		decorator(){}
+		decorator(const decorator&) = default;
+		decorator(decorator&&) = default;
+		decorator& operator=(const decorator&) = default;
+		decorator& operator=(decorator&&) = default;
+
+		~decorator(){
+			decorator_finalize(*this, static_cast<ArchiveData*>(this));	// found by ADL
+		}
 	};
 
 	template<typename Decorator> struct get_archive_type;
@@ -117,6 +154,67 @@ namespace xirang{ namespace io{
 		COMMON_IO_ADAPTOR_HELPER();
 	};
 
+	template<typename Derive> struct proxy_positional_reader_p : positional_reader
+	{
+		typedef typename positional_reader::iterator iterator;
+
+		virtual range<iterator> read_at(long_size_t off, const range<iterator>& buf) const {
+			return underlying_<positional_reader>().read_at(off, buf);
+		}
+
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
+	template<typename Derive> struct proxy_async_reader_p : async_reader
+	{
+		typedef typename async_reader::iterator iterator;
+
+		virtual async_result async_read(long_size_t off, const range<iterator>& buf) {
+			return underlying_<async_reader>().async_read(off, buf);
+		}
+
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
+	template<typename Derive> struct proxy_async_writer_p : async_writer
+	{
+		typedef typename async_writer::const_iterator const_iterator;
+
+		virtual async_result async_write(long_size_t off, const range<const_iterator>& buf) {
+			return underlying_<async_writer>().async_write(off, buf);
+		}
+
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
+	template<typename Derive> struct proxy_native_handle_p : native_handle
+	{
+		virtual native_handle_t handle(){
+			return underlying_<native_handle>().handle();
+		}
+		virtual void handle_written(long_size_t first, long_size_t last){
+			underlying_<native_handle>().handle_written(first, last);
+		}
+
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
+	template<typename Derive> struct proxy_vector_reader_p : vector_reader
+	{
+		typedef typename vector_reader::iterator iterator;
+
+		virtual long_size_t readv(const range<const range<iterator>*>& bufs) {
+			return underlying_<vector_reader>().readv(bufs);
+		}
+
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
 	template<typename Derive> struct proxy_writer_p : writer
 	{
 		typedef typename writer::iterator iterator;
@@ -135,6 +233,18 @@ namespace xirang{ namespace io{
 		COMMON_IO_ADAPTOR_HELPER();
 	};
 
+	template<typename Derive> struct proxy_vector_writer_p : vector_writer
+	{
+		typedef typename vector_writer::const_iterator const_iterator;
+
+		virtual long_size_t writev(const range<const range<const_iterator>*>& bufs) {
+			return underlying_<vector_writer>().writev(bufs);
+		}
+
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
 	template<typename Derive> struct proxy_ioctrl_p : ioctrl
 	{
 		virtual long_size_t truncate(long_size_t size){
@@ -322,6 +432,32 @@ namespace xirang{ namespace io{
 		COMMON_IO_ADAPTOR_HELPER();
 	};
 
+	template<typename Derive> struct multiplex_vector_reader_p : vector_reader
+	{
+		typedef vector_reader::iterator iterator;
+
+		virtual long_size_t readv(const range<const range<iterator>*>& bufs) {
+            multiplex_offset_tracker<Derive> tracker(derive_());
+			return underlying_<vector_reader>().readv(bufs);
+		}
+
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
+	template<typename Derive> struct multiplex_vector_writer_p : vector_writer
+	{
+		typedef vector_writer::const_iterator const_iterator;
+
+		virtual long_size_t writev(const range<const range<const_iterator>*>& bufs) {
+            multiplex_offset_tracker<Derive> tracker(derive_());
+			return underlying_<vector_writer>().writev(bufs);
+		}
+
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
 	template<typename Derive> struct multiplex_random_p : random
 	{
 		virtual long_size_t offset() const {
@@ -354,6 +490,9 @@ namespace xirang{ namespace io{
 	template<typename Derive> using multiplex_ioinfo_p = proxy_ioinfo_p<Derive>;
 	template<typename Derive> using multiplex_read_map_p = proxy_read_map_p<Derive>;
 	template<typename Derive> using multiplex_write_map_p = proxy_write_map_p<Derive>;
+	template<typename Derive> using multiplex_positional_reader_p = proxy_positional_reader_p<Derive>;
+	template<typename Derive> using multiplex_async_reader_p = proxy_async_reader_p<Derive>;
+	template<typename Derive> using multiplex_async_writer_p = proxy_async_writer_p<Derive>;
 
 	// TODO: remove multiplex dependency
 	template<typename ArchiveType> struct sub_archive: public proxy_archive<ArchiveType>
@@ -402,6 +541,63 @@ namespace xirang{ namespace io{
 		COMMON_IO_ADAPTOR_HELPER();
 	};
 
+	template<typename Derive> struct sub_positional_reader_p : positional_reader
+	{
+		typedef typename positional_reader::iterator iterator;
+
+		virtual range<iterator> read_at(long_size_t off, const range<iterator>& buf) const {
+			auto size = derive_().last - derive_().first;
+			if (off >= size)
+				return buf;
+			auto min_size = std::min<long_size_t>(buf.size(), size - off);
+			auto rest = underlying_<positional_reader>().read_at(derive_().first + off, range<iterator>(buf.begin(), buf.begin() + min_size));
+			return range<iterator>(rest.begin(), buf.end());
+		}
+
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
+	namespace io_private_{
+		inline async_result ready_result_(long_size_t size){
+			std::promise<long_size_t> ret;
+			ret.set_value(size);
+			return ret.get_future();
+		}
+	}
+
+	template<typename Derive> struct sub_async_reader_p : async_reader
+	{
+		typedef typename async_reader::iterator iterator;
+
+		virtual async_result async_read(long_size_t off, const range<iterator>& buf) {
+			auto size = derive_().last - derive_().first;
+			if (off >= size)
+				return io_private_::ready_result_(0);
+			auto min_size = std::min<long_size_t>(buf.size(), size - off);
+			return underlying_<async_reader>().async_read(derive_().first + off, range<iterator>(buf.begin(), buf.begin() + min_size));
+		}
+
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
+	template<typename Derive> struct sub_async_writer_p : async_writer
+	{
+		typedef typename async_writer::const_iterator const_iterator;
+
+		virtual async_result async_write(long_size_t off, const range<const_iterator>& buf) {
+			auto size = derive_().last - derive_().first;
+			if (off >= size)
+				return io_private_::ready_result_(0);
+			auto min_size = std::min<long_size_t>(buf.size(), size - off);
+			return underlying_<async_writer>().async_write(derive_().first + off, range<const_iterator>(buf.begin(), buf.begin() + min_size));
+		}
+
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
 	template<typename Derive> struct sub_writer_p : writer
 	{
 		typedef typename writer::iterator iterator;
@@ -429,6 +625,44 @@ namespace xirang{ namespace io{
 		COMMON_IO_ADAPTOR_HELPER();
 	};
 
+	template<typename Derive> struct sub_vector_reader_p : vector_reader
+	{
+		typedef typename vector_reader::iterator iterator;
+
+		virtual long_size_t readv(const range<const range<iterator>*>& bufs) {
+			auto current = underlying_<sequence>().offset();
+			if (current < derive_().first || current >= derive_().last)
+				return 0;
+
+			std::vector<range<iterator>> clipped;
+			if (!io_private_::clip_ranges_(bufs, derive_().last - current, clipped))
+				return underlying_<vector_reader>().readv(bufs);
+			return underlying_<vector_reader>().readv(make_range(clipped.data(), clipped.data() + clipped.size()));
+		}
+
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
+	template<typename Derive> struct sub_vector_writer_p : vector_writer
+	{
+		typedef typename vector_writer::const_iterator const_iterator;
+
+		virtual long_size_t writev(const range<const range<const_iterator>*>& bufs) {
+			auto current = underlying_<sequence>().offset();
+			if (current < derive_().first || current >= derive_().last)
+				return 0;
+
+			std::vector<range<const_iterator>> clipped;
+			if (!io_private_::clip_ranges_(bufs, derive_().last - current, clipped))
+				return underlying_<vector_writer>().writev(bufs);
+			return underlying_<vector_writer>().writev(make_range(clipped.data(), clipped.data() + clipped.size()));
+		}
+
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
 	template<typename Derive> struct sub_ioctrl_p : ioctrl
 	{
 		virtual long_size_t truncate(long_size_t size){
@@ -492,6 +726,28 @@ namespace xirang{ namespace io{
 		COMMON_IO_ADAPTOR_HELPER();
 	};
 
+	/// ao_access_hint is limited to the sub range, other options are forwarded
+	template<typename Derive> struct sub_options_p : options
+	{
+		virtual any getopt(int id, const any & optdata = any() ) const {
+			return underlying_<options>().getopt(id, optdata);
+		}
+		virtual any setopt(int id, const any & optdata,  const any & indata= any()){
+			if (id != ao_access_hint)
+				return underlying_<options>().setopt(id, optdata, indata);
+
+			ext_heap::handle h(0, derive_().last - derive_().first);
+			if (!indata.empty())
+				h = any_cast<ext_heap::handle>(indata);
+			auto last = std::min<long_size_t>(h.end(), derive_().last - derive_().first);
+			AIO_PRE_CONDITION(h.begin() >= 0 && long_size_t(h.begin()) <= last);
+			return underlying_<options>().setopt(id, optdata,
+					any(ext_heap::handle(derive_().first + h.begin(), derive_().first + last)));
+		}
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
 	template<typename Derive> struct sub_read_map_p : read_map
 	{
 		virtual iauto<read_view> view_rd(ext_heap::handle h){
@@ -662,6 +918,444 @@ namespace xirang{ namespace io{
 		COMMON_IO_ADAPTOR_HELPER();
 	};
 
+	/// buffered_archive keeps a read-ahead buffer and a write-behind buffer in front of the underlying archive,
+	/// so small reads and writes, e.g. scalar loads of exchange serializer, don't reach the underlying archive one by one.
+	/// data is written back by sync(), seek(), truncate(), a following read, or destruction.
+	/// reads and writes can only be interleaved if buffered_random_p is decorated as well.
+	template<typename ArchiveType>
+	struct buffered_archive : public proxy_archive<ArchiveType>
+	{
+		typedef proxy_archive<ArchiveType> base;
+		buffered_archive(): capacity(default_buffer_size), rpos(0), rend(0){}
+		template<typename RealArchiveType>
+		explicit buffered_archive(RealArchiveType&& ar, std::size_t buffer_size = default_buffer_size)
+			: base(std::forward<RealArchiveType>(ar)), capacity(buffer_size), rpos(0), rend(0)
+		{
+			AIO_PRE_CONDITION(buffer_size > 0);
+		}
+
+		static const std::size_t default_buffer_size = 64 * 1024;
+
+		std::size_t capacity;
+		std::vector<byte> rbuf;		// read-ahead data is [rpos, rend)
+		std::size_t rpos, rend;
+		std::vector<byte> wbuf;		// pending data, not written yet
+	};
+
+	namespace io_private_{
+		template<typename Derive> bool buffered_flush_(Derive& , std::false_type){ return true; }
+		template<typename Derive> bool buffered_flush_(Derive& d, std::true_type){
+			if (d.wbuf.empty())
+				return true;
+			auto& wr = get_i_<writer>(d.underlying());
+			range<const byte*> rest(d.wbuf.data(), d.wbuf.data() + d.wbuf.size());
+			while (!rest.empty() && wr.writable())
+				rest = wr.write(rest);
+			d.wbuf.erase(d.wbuf.begin(), d.wbuf.begin() + (rest.begin() - d.wbuf.data()));
+			return d.wbuf.empty();
+		}
+		/// write pending data back if Derive is a writer
+		template<typename Derive> bool buffered_flush_(Derive& d){
+			return buffered_flush_(d, std::integral_constant<bool, std::is_base_of<writer, Derive>::value>());
+		}
+
+		template<typename Derive> void buffered_drop_(Derive& d, std::false_type){ d.rpos = d.rend = 0; }
+		template<typename Derive> void buffered_drop_(Derive& d, std::true_type){
+			if (d.rpos != d.rend){
+				auto& rnd = get_i_<random>(d.underlying());
+				rnd.seek(rnd.offset() - (d.rend - d.rpos));
+			}
+			d.rpos = d.rend = 0;
+		}
+		/// discard read-ahead data, and rewind the underlying archive if Derive is random
+		template<typename Derive> void buffered_drop_(Derive& d){
+			buffered_drop_(d, std::integral_constant<bool, std::is_base_of<random, Derive>::value>());
+		}
+	}
+
+	/// write back the pending data when the decorator is destroyed
+	template<typename Derive, typename ArchiveType> void decorator_finalize(Derive& d, buffered_archive<ArchiveType>* ){
+		try{
+			io_private_::buffered_flush_(d);
+		}
+		catch(...){}	// call sync() to observe the error.
+	}
+
+	template<typename Derive> struct buffered_reader_p : reader
+	{
+		typedef typename reader::iterator iterator;
+
+		virtual range<iterator> read(const range<iterator>& buf) {
+			auto& d = derive_();
+			if (!io_private_::buffered_flush_(d))
+				AIO_THROW(write_exception)("failed to write back the buffered data");
+
+			auto pos = buf.begin();
+			auto n = std::min<std::size_t>(d.rend - d.rpos, buf.size());
+			pos = std::copy(d.rbuf.data() + d.rpos, d.rbuf.data() + d.rpos + n, pos);
+			d.rpos += n;
+			if (pos == buf.end())
+				return range<iterator>(pos, buf.end());
+
+			// the read-ahead buffer is empty now
+			d.rpos = d.rend = 0;
+			if (std::size_t(buf.end() - pos) >= d.capacity)
+				return underlying_<reader>().read(range<iterator>(pos, buf.end()));
+
+			d.rbuf.resize(d.capacity);
+			auto rest = underlying_<reader>().read(range<iterator>(d.rbuf.data(), d.rbuf.data() + d.capacity));
+			d.rend = rest.begin() - d.rbuf.data();
+
+			n = std::min<std::size_t>(d.rend, buf.end() - pos);
+			pos = std::copy(d.rbuf.data(), d.rbuf.data() + n, pos);
+			d.rpos = n;
+			return range<iterator>(pos, buf.end());
+		}
+
+		virtual bool readable() const {
+			return derive_().rpos != derive_().rend
+				|| underlying_<reader>().readable();
+		}
+
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
+	template<typename Derive> struct buffered_writer_p : writer
+	{
+		typedef typename writer::iterator iterator;
+		typedef typename writer::const_iterator const_iterator;
+
+		virtual range<const_iterator> write(const range<const_iterator>& r){
+			auto& d = derive_();
+			io_private_::buffered_drop_(d);
+
+			if (d.wbuf.size() + r.size() > d.capacity && !io_private_::buffered_flush_(d))
+				return r;
+			if (r.size() >= d.capacity)
+				return underlying_<writer>().write(r);
+
+			d.wbuf.insert(d.wbuf.end(), r.begin(), r.end());
+			return range<const_iterator>(r.end(), r.end());
+		}
+		virtual bool writable() const{
+			return underlying_<writer>().writable();
+		}
+		virtual void sync(){
+			if (!io_private_::buffered_flush_(derive_()))
+				AIO_THROW(write_exception)("failed to write back the buffered data");
+			underlying_<writer>().sync();
+		}
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
+	template<typename Derive> struct buffered_random_p : random
+	{
+		virtual long_size_t offset() const{
+			return underlying_<random>().offset() - (derive_().rend - derive_().rpos) + derive_().wbuf.size();
+		}
+		virtual long_size_t size() const{
+			return std::max(underlying_<random>().size(), offset());
+		}
+		virtual long_size_t seek(long_size_t off){
+			auto& d = derive_();
+			if (!io_private_::buffered_flush_(d))
+				AIO_THROW(write_exception)("failed to write back the buffered data");
+
+			if (d.rend != 0){	// seek inside the read-ahead buffer
+				auto last = underlying_<random>().offset();
+				auto first = last - d.rend;
+				if (off >= first && off <= last){
+					d.rpos = off - first;
+					return off;
+				}
+				d.rpos = d.rend = 0;
+			}
+			return underlying_<random>().seek(off);
+		}
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
+	template<typename Derive> struct buffered_ioctrl_p : ioctrl
+	{
+		virtual long_size_t truncate(long_size_t size){
+			auto& d = derive_();
+			if (!io_private_::buffered_flush_(d))
+				AIO_THROW(write_exception)("failed to write back the buffered data");
+			io_private_::buffered_drop_(d);
+			return underlying_<ioctrl>().truncate(size);
+		}
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
+	template<typename Derive> struct buffered_ioinfo_p : ioinfo
+	{
+		virtual long_size_t size() const{
+			auto self = const_cast<buffered_ioinfo_p*>(this);
+			if (!io_private_::buffered_flush_(self->derive_()))
+				AIO_THROW(write_exception)("failed to write back the buffered data");
+			return underlying_<ioinfo>().size();
+		}
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+	template<typename Derive> using buffered_options_p = proxy_options_p<Derive>;
+
+	/// counters of stats_archive, read by getopt(ao_io_stats).
+	/// the counters are updated with relaxed atomics, a copy is a snapshot which may be torn between counters.
+	struct io_stats
+	{
+		enum operation { op_read, op_write, op_seek, op_view_rd, op_view_wr, op_sync, op_count };
+
+		/// bucket 0 counts the calls took less than 1us, bucket i counts [2^(i-1), 2^i) us, the last one counts the rest.
+		static const std::size_t histogram_size = 32;
+
+		struct counter
+		{
+			std::atomic<long_size_t> calls;
+			std::atomic<long_size_t> bytes;
+			std::atomic<long_size_t> micro_seconds;	///< sum of latencies
+			std::atomic<long_size_t> histogram[histogram_size];
+		};
+		counter counters[op_count];
+
+		io_stats(){ reset(); }
+		io_stats(const io_stats& rhs){ *this = rhs; }
+		io_stats& operator=(const io_stats& rhs){
+			for (std::size_t i = 0; i < op_count; ++i){
+				auto& c = counters[i];
+				auto& r = rhs.counters[i];
+				c.calls.store(r.calls.load(std::memory_order_relaxed), std::memory_order_relaxed);
+				c.bytes.store(r.bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+				c.micro_seconds.store(r.micro_seconds.load(std::memory_order_relaxed), std::memory_order_relaxed);
+				for (std::size_t j = 0; j < histogram_size; ++j)
+					c.histogram[j].store(r.histogram[j].load(std::memory_order_relaxed), std::memory_order_relaxed);
+			}
+			return *this;
+		}
+
+		void reset(){
+			for (auto& c : counters){
+				c.calls.store(0, std::memory_order_relaxed);
+				c.bytes.store(0, std::memory_order_relaxed);
+				c.micro_seconds.store(0, std::memory_order_relaxed);
+				for (auto& h : c.histogram)
+					h.store(0, std::memory_order_relaxed);
+			}
+		}
+		/// safe for concurrent calls, e.g. from positional_reader::read_at
+		void add(operation op, long_size_t bytes, long_size_t micro_seconds){
+			auto& c = counters[op];
+			c.calls.fetch_add(1, std::memory_order_relaxed);
+			c.bytes.fetch_add(bytes, std::memory_order_relaxed);
+			c.micro_seconds.fetch_add(micro_seconds, std::memory_order_relaxed);
+			c.histogram[bucket_of(micro_seconds)].fetch_add(1, std::memory_order_relaxed);
+		}
+		static std::size_t bucket_of(long_size_t micro_seconds){
+			std::size_t i = 0;
+			for (; micro_seconds != 0 && i + 1 < histogram_size; micro_seconds >>= 1)
+				++i;
+			return i;
+		}
+	};
+
+	/// stats_archive counts calls, bytes and latencies of the underlying archive, see io_stats.
+	/// the counters are atomic, so the const read_at of stats_positional_reader_p can be called concurrently.
+	template<typename ArchiveType>
+	struct stats_archive : public proxy_archive<ArchiveType>
+	{
+		typedef proxy_archive<ArchiveType> base;
+		stats_archive(){}
+		template<typename RealArchiveType>
+		explicit stats_archive(RealArchiveType&& ar) : base(std::forward<RealArchiveType>(ar)){}
+
+		mutable io_stats stats;
+	};
+
+	namespace io_private_{
+		/// record one call when destroyed, the latency is measured from construction
+		struct stats_scope_
+		{
+			stats_scope_(io_stats& s, io_stats::operation op_)
+				: stats(s), op(op_), bytes(0), start(std::chrono::steady_clock::now()){}
+			~stats_scope_(){
+				auto elapsed = std::chrono::steady_clock::now() - start;
+				stats.add(op, bytes, std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+			}
+
+			io_stats& stats;
+			io_stats::operation op;
+			long_size_t bytes;
+			std::chrono::steady_clock::time_point start;
+		};
+	}
+
+	template<typename Derive> struct stats_reader_p : reader
+	{
+		typedef typename reader::iterator iterator;
+
+		virtual range<iterator> read(const range<iterator>& buf) {
+			io_private_::stats_scope_ scope(derive_().stats, io_stats::op_read);
+			auto rest = underlying_<reader>().read(buf);
+			scope.bytes = rest.begin() - buf.begin();
+			return rest;
+		}
+
+		virtual bool readable() const {
+			return underlying_<reader>().readable();
+		}
+
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
+	/// read_at is counted as op_read
+	template<typename Derive> struct stats_positional_reader_p : positional_reader
+	{
+		typedef typename positional_reader::iterator iterator;
+
+		virtual range<iterator> read_at(long_size_t off, const range<iterator>& buf) const {
+			io_private_::stats_scope_ scope(derive_().stats, io_stats::op_read);
+			auto rest = underlying_<positional_reader>().read_at(off, buf);
+			scope.bytes = rest.begin() - buf.begin();
+			return rest;
+		}
+
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
+	/// readv is counted as op_read
+	template<typename Derive> struct stats_vector_reader_p : vector_reader
+	{
+		typedef typename vector_reader::iterator iterator;
+
+		virtual long_size_t readv(const range<const range<iterator>*>& bufs) {
+			io_private_::stats_scope_ scope(derive_().stats, io_stats::op_read);
+			return scope.bytes = underlying_<vector_reader>().readv(bufs);
+		}
+
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
+	template<typename Derive> struct stats_writer_p : writer
+	{
+		typedef typename writer::iterator iterator;
+		typedef typename writer::const_iterator const_iterator;
+
+		virtual range<const_iterator> write(const range<const_iterator>& r){
+			io_private_::stats_scope_ scope(derive_().stats, io_stats::op_write);
+			auto rest = underlying_<writer>().write(r);
+			scope.bytes = rest.begin() - r.begin();
+			return rest;
+		}
+		virtual bool writable() const{
+			return underlying_<writer>().writable();
+		}
+		virtual void sync(){
+			io_private_::stats_scope_ scope(derive_().stats, io_stats::op_sync);
+			underlying_<writer>().sync();
+		}
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
+	/// writev is counted as op_write
+	template<typename Derive> struct stats_vector_writer_p : vector_writer
+	{
+		typedef typename vector_writer::const_iterator const_iterator;
+
+		virtual long_size_t writev(const range<const range<const_iterator>*>& bufs) {
+			io_private_::stats_scope_ scope(derive_().stats, io_stats::op_write);
+			return scope.bytes = underlying_<vector_writer>().writev(bufs);
+		}
+
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
+	template<typename Derive> struct stats_random_p : random
+	{
+		virtual long_size_t offset() const{
+			return underlying_<random>().offset();
+		}
+		virtual long_size_t size() const{
+			return underlying_<random>().size();
+		}
+		virtual long_size_t seek(long_size_t off){
+			io_private_::stats_scope_ scope(derive_().stats, io_stats::op_seek);
+			return underlying_<random>().seek(off);
+		}
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
+	/// view_rd counts the requested size as bytes
+	template<typename Derive> struct stats_read_map_p : read_map
+	{
+		virtual iauto<read_view> view_rd(ext_heap::handle h){
+			io_private_::stats_scope_ scope(derive_().stats, io_stats::op_view_rd);
+			scope.bytes = h.size();
+			return underlying_<read_map>().view_rd(h);
+		}
+		virtual long_size_t size() const{
+			return underlying_<read_map>().size();
+		}
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
+	/// view_wr counts the requested size as bytes, the write back of view is not measured.
+	template<typename Derive> struct stats_write_map_p : write_map
+	{
+		virtual iauto<write_view> view_wr(ext_heap::handle h) {
+			io_private_::stats_scope_ scope(derive_().stats, io_stats::op_view_wr);
+			scope.bytes = h.size();
+			return underlying_<write_map>().view_wr(h);
+		}
+		virtual long_size_t size() const{
+			return underlying_<write_map>().size();
+		}
+		virtual void sync() {
+			io_private_::stats_scope_ scope(derive_().stats, io_stats::op_sync);
+			underlying_<write_map>().sync();
+		}
+		virtual long_size_t truncate(long_size_t s){
+			return underlying_<write_map>().truncate(s);
+		}
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+
+	/// getopt(ao_io_stats) returns io_stats, setopt(ao_io_stats) resets it. other options are forwarded
+	template<typename Derive> struct stats_options_p : options
+	{
+		virtual any getopt(int id, const any & optdata = any() ) const {
+			if (id == ao_io_stats)
+				return any(derive_().stats);
+			return underlying_<options>().getopt(id, optdata);
+		}
+		virtual any setopt(int id, const any & optdata,  const any & indata= any()){
+			if (id == ao_io_stats){
+				derive_().stats.reset();
+				return any(derive_().stats);
+			}
+			return underlying_<options>().setopt(id, optdata, indata);
+		}
+		private:
+		COMMON_IO_ADAPTOR_HELPER();
+	};
+	template<typename Derive> using stats_ioctrl_p = proxy_ioctrl_p<Derive>;
+	template<typename Derive> using stats_ioinfo_p = proxy_ioinfo_p<Derive>;
+	template<typename Derive> using stats_sequence_p = proxy_sequence_p<Derive>;
+	template<typename Derive> using stats_native_handle_p = proxy_native_handle_p<Derive>;
+	template<typename Derive> using stats_async_reader_p = proxy_async_reader_p<Derive>;
+	template<typename Derive> using stats_async_writer_p = proxy_async_writer_p<Derive>;
+
 	template<typename Derive> using stream_to_map_archive = proxy_archive<Derive>;
 
 	struct stream_to_write_view : write_view
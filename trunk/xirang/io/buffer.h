@@ -52,6 +52,16 @@ namespace xirang{namespace io{ namespace exchange{
 		return ar;
 	}
 
+	/// load a byte buffer without copy, buf points into the memory of the source
+	template<typename Ar, typename =
+		typename std::enable_if< is_memory_deserializer<Ar>::value>::type>
+	Ar& load(Ar& ar, range<const byte*>& buf)
+	{
+		size_t size = exchange_cast<size_t>(load<uint32_t>(ar));
+		buf = ar.get().take(size);
+		return ar;
+	}
+
 	template<typename Ar, typename =
 		typename std::enable_if< s11n::is_serializer<Ar>::value>::type>
 	Ar& save(Ar& ar, const buffer<byte>& buf)
@@ -69,13 +79,10 @@ namespace xirang{namespace io{ namespace exchange{
 	{
 		size_t size = exchange_cast<size_t>(load<uint32_t>(ar));
 
-		typedef typename exchange_type_of<T>::type U;
 		buffer<T> rbuf;
-		rbuf.reserve(size);
-		for (auto i = size; i > 0; --i){
-			rbuf.push_back(exchange_cast<T>(load<U>(ar)));
-		}
-		buf.swap(buf);
+		rbuf.resize(size);
+		load_range(ar, make_range(rbuf.begin(), rbuf.end()));
+		rbuf.swap(buf);
 
 		return ar;
 	}
@@ -85,13 +92,8 @@ namespace xirang{namespace io{ namespace exchange{
 	Ar& save(Ar& ar, const buffer<T>& buf)
 	{
 		uint32_t size = exchange_cast<uint32_t>(buf.size());
-		save(ar, local2ex_f(size));
-		if (!buf.empty())
-		{
-			typedef typename exchange_type_of<T>::type U;
-			for (auto i : buf)
-				ar & exchange_cast<U>(i);
-		}
+		save(ar, size);
+		save_range(ar, make_range(buf.begin(), buf.end()));
 		return ar;
 	}
 }}}
@@ -2,11 +2,248 @@
 #define AIO_COMMON_IO_S11N_EXCHANGE_H_
 #include <xirang/io/s11nbase.h>
 #include <xirang/byteorder.h>
+#include <xirang/varint.h>
 #include <limits>
+#include <vector>
 
 namespace xirang{ namespace io{ namespace exchange{
 
-	template<typename Ar> struct serializer : public s11n::serializer_base<Ar>, public io::writer{
+	/// gathers small writes in a staging buffer, so the underlying archive gets a few large writes
+	/// instead of one write per scalar. pending data is written back by flush(), sync() or destruction.
+	template<typename Ar> class buffered_sink
+	{
+	public:
+		typedef const byte* const_iterator;
+		typedef const byte* iterator;
+
+		buffered_sink(Ar& ar, std::size_t buffer_size)
+			: m_archive(&ar), m_capacity(buffer_size)
+		{
+			AIO_PRE_CONDITION(buffer_size > 0);
+			m_buffer.reserve(buffer_size);
+		}
+		buffered_sink(buffered_sink&& rhs)
+			: m_archive(rhs.m_archive), m_capacity(rhs.m_capacity), m_buffer(std::move(rhs.m_buffer))
+		{
+			rhs.m_buffer.clear();
+		}
+		~buffered_sink(){
+			try{
+				flush();
+			}
+			catch(...){}	// call flush() to observe the error.
+		}
+
+		range<const_iterator> write(const range<const_iterator>& r){
+			if (m_buffer.size() + r.size() > m_capacity)
+				flush();
+			if (r.size() >= m_capacity)
+				return block_write(get_interface<io::writer>(*m_archive), r);
+
+			m_buffer.insert(m_buffer.end(), r.begin(), r.end());
+			return range<const_iterator>(r.end(), r.end());
+		}
+		bool writable() const{
+			return get_interface<io::writer>(*m_archive).writable();
+		}
+		void sync(){
+			flush();
+			get_interface<io::writer>(*m_archive).sync();
+		}
+
+		/// write the pending data to the underlying archive
+		void flush(){
+			if (m_buffer.empty())
+				return;
+			range<const byte*> pending(m_buffer.data(), m_buffer.data() + m_buffer.size());
+			auto rest = block_write(get_interface<io::writer>(*m_archive), pending);
+			m_buffer.clear();
+			if (!rest.empty())
+				AIO_THROW(io::write_exception)("failed to write back the buffered data");
+		}
+
+		Ar& underlying() const { return *m_archive;}
+
+	private:
+		buffered_sink(const buffered_sink&) = delete;
+		buffered_sink& operator=(const buffered_sink&) = delete;
+
+		Ar* m_archive;
+		std::size_t m_capacity;
+		std::vector<byte> m_buffer;
+	};
+
+	/// reads ahead up to buffer_size bytes from the underlying archive, and serves small reads from the buffer.
+	/// the underlying archive may be positioned beyond the last loaded data.
+	template<typename Ar> class buffered_source
+	{
+	public:
+		typedef byte* iterator;
+
+		buffered_source(Ar& ar, std::size_t buffer_size)
+			: m_archive(&ar), m_capacity(buffer_size), m_pos(0), m_end(0)
+		{
+			AIO_PRE_CONDITION(buffer_size > 0);
+		}
+		buffered_source(buffered_source&& rhs)
+			: m_archive(rhs.m_archive), m_capacity(rhs.m_capacity), m_buffer(std::move(rhs.m_buffer))
+			, m_pos(rhs.m_pos), m_end(rhs.m_end)
+		{
+			rhs.m_pos = rhs.m_end = 0;
+		}
+
+		range<iterator> read(const range<iterator>& buf){
+			auto pos = buf.begin();
+			auto n = std::min<std::size_t>(m_end - m_pos, buf.size());
+			pos = std::copy(m_buffer.data() + m_pos, m_buffer.data() + m_pos + n, pos);
+			m_pos += n;
+			if (pos == buf.end())
+				return range<iterator>(pos, buf.end());
+
+			// the read-ahead buffer is empty now
+			m_pos = m_end = 0;
+			auto& rd = get_interface<io::reader>(*m_archive);
+			if (std::size_t(buf.end() - pos) >= m_capacity)
+				return rd.read(range<iterator>(pos, buf.end()));
+
+			m_buffer.resize(m_capacity);
+			auto rest = rd.read(range<iterator>(m_buffer.data(), m_buffer.data() + m_capacity));
+			m_end = rest.begin() - m_buffer.data();
+
+			n = std::min<std::size_t>(m_end, buf.end() - pos);
+			pos = std::copy(m_buffer.data(), m_buffer.data() + n, pos);
+			m_pos = n;
+			return range<iterator>(pos, buf.end());
+		}
+		bool readable() const{
+			return m_pos != m_end || get_interface<io::reader>(*m_archive).readable();
+		}
+
+		/// read ahead until n bytes are buffered or the underlying archive ends
+		/// \return the buffered data, it's shorter than n only at the end of the underlying archive
+		range<const byte*> fill(std::size_t n){
+			if (m_end - m_pos < n){
+				std::size_t size = m_end - m_pos;
+				std::copy(m_buffer.data() + m_pos, m_buffer.data() + m_end, m_buffer.data());
+				m_buffer.resize(std::max(m_capacity, n));
+				m_pos = 0;
+				m_end = size;
+
+				auto& rd = get_interface<io::reader>(*m_archive);
+				range<iterator> rest(m_buffer.data() + m_end, m_buffer.data() + m_buffer.size());
+				while (m_end < n && !rest.empty() && rd.readable()){
+					rest = rd.read(rest);
+					m_end = rest.begin() - m_buffer.data();
+				}
+			}
+			return range<const byte*>(m_buffer.data() + m_pos, m_buffer.data() + m_end);
+		}
+		/// skip n bytes of the data returned by fill()
+		void consume(std::size_t n){
+			AIO_PRE_CONDITION(n <= m_end - m_pos);
+			m_pos += n;
+		}
+
+		Ar& underlying() const { return *m_archive;}
+
+	private:
+		buffered_source(const buffered_source&) = delete;
+		buffered_source& operator=(const buffered_source&) = delete;
+
+		Ar* m_archive;
+		std::size_t m_capacity;
+		std::vector<byte> m_buffer;		// read-ahead data is [m_pos, m_end)
+		std::size_t m_pos, m_end;
+	};
+
+	/// reads from contiguous memory, e.g. a mapped read_view or the data of a buffer.
+	/// strings and byte ranges loaded from it point into the memory instead of being copied,
+	/// they are valid as long as the memory, or the view owned by the source.
+	class memory_source
+	{
+	public:
+		typedef byte* iterator;
+
+		explicit memory_source(const range<const byte*>& data = range<const byte*>())
+			: m_pos(data.begin()), m_end(data.end())
+		{}
+		/// the view is kept alive by the source
+		explicit memory_source(iauto<read_view>&& view)
+			: m_view(std::move(view)), m_pos(0), m_end(0)
+		{
+			if (m_view){
+				auto data = m_view.get<read_view>().address();
+				m_pos = data.begin();
+				m_end = data.end();
+			}
+		}
+		memory_source(memory_source&& rhs)
+			: m_view(std::move(rhs.m_view)), m_pos(rhs.m_pos), m_end(rhs.m_end)
+		{
+			rhs.m_pos = rhs.m_end = 0;
+		}
+
+		range<iterator> read(const range<iterator>& buf){
+			auto n = std::min<std::size_t>(m_end - m_pos, buf.size());
+			auto pos = std::copy(m_pos, m_pos + n, buf.begin());
+			m_pos += n;
+			return range<iterator>(pos, buf.end());
+		}
+		bool readable() const{
+			return m_pos != m_end;
+		}
+
+		/// lend the next n bytes
+		/// \throw io::read_exception if less than n bytes are left
+		range<const byte*> take(std::size_t n){
+			if (std::size_t(m_end - m_pos) < n)
+				AIO_THROW(io::read_exception)("not enough data");
+			range<const byte*> ret(m_pos, m_pos + n);
+			m_pos += n;
+			return ret;
+		}
+		/// the data not read yet
+		range<const byte*> rest() const{
+			return range<const byte*>(m_pos, m_end);
+		}
+
+	private:
+		memory_source(const memory_source&) = delete;
+		memory_source& operator=(const memory_source&) = delete;
+
+		iauto<read_view> m_view;
+		const byte* m_pos;
+		const byte* m_end;
+	};
+}
+
+	/// block_write/block_read of the staging buffers are resolved statically, so the scalar save/load
+	/// of a buffered serializer don't go through the virtual reader/writer interfaces.
+	template<typename Ar>
+	range<writer::iterator> block_write(exchange::buffered_sink<Ar>& wr, const range<writer::iterator>& buf){
+		return wr.write(buf);
+	}
+	template<typename Ar>
+	range<reader::iterator> block_read(exchange::buffered_source<Ar>& rd, const range<reader::iterator>& buf){
+		auto rest = buf;
+		while (!rest.empty() && rd.readable())
+			rest = rd.read(rest);
+		return rest;
+	}
+	inline range<reader::iterator> block_read(exchange::memory_source& rd, const range<reader::iterator>& buf){
+		return rd.read(buf);
+	}
+
+namespace exchange{
+
+	/// scalars are saved in the size of their exchange type
+	struct fixed_encoding{};
+	/// integers wider than a byte are saved as LEB128 varints, signed ones are zigzag encoded first.
+	/// other scalars are saved as fixed_encoding.
+	struct varint_encoding{};
+
+	template<typename Ar, typename Encoding = fixed_encoding> struct serializer : public s11n::serializer_base<Ar>, public io::writer{
+		typedef Encoding encoding_type;
 		explicit serializer(Ar& ar) : s11n::serializer_base<Ar>(ar){};
 
 		range<const byte*> write(const range<const byte*>& r){
@@ -22,7 +259,8 @@ namespace xirang{ namespace io{ namespace exchange{
 			return this->get().sync();
 		}
 	};
-	template<typename Ar> struct deserializer : public s11n::deserializer_base<Ar> , public io::reader{
+	template<typename Ar, typename Encoding = fixed_encoding> struct deserializer : public s11n::deserializer_base<Ar> , public io::reader{
+		typedef Encoding encoding_type;
 		explicit deserializer(Ar& ar) : s11n::deserializer_base<Ar>(ar){};
 		range<byte*> read(const range<byte*>& buf){
 			return this->get().read(buf);
@@ -34,6 +272,53 @@ namespace xirang{ namespace io{ namespace exchange{
 	};
 	template<typename Ar> serializer<Ar> as_sink(Ar& ar){ return serializer<Ar>(ar);}
 	template<typename Ar> deserializer<Ar> as_source(Ar& ar){ return deserializer<Ar>(ar);}
+	template<typename Ar, typename Encoding> serializer<Ar, Encoding> as_sink(Ar& ar, Encoding){ return serializer<Ar, Encoding>(ar);}
+
+	/// true if Ar deserializes from a memory_source, so it can load values without copy
+	template<typename Ar> struct is_memory_deserializer : public std::integral_constant<bool,
+		s11n::is_deserializer<Ar>::value
+			&& std::is_same<typename std::decay<decltype(std::declval<Ar&>().get())>::type, memory_source>::value>
+	{};
+	template<typename Ar, typename Encoding> deserializer<Ar, Encoding> as_source(Ar& ar, Encoding){ return deserializer<Ar, Encoding>(ar);}
+
+	const std::size_t default_stage_size = 4096;
+
+	/// serializer with a staging buffer, see buffered_sink. flush() before reading the size or position
+	/// of the underlying archive.
+	template<typename Ar, typename Encoding = fixed_encoding> struct buffered_serializer : public serializer<buffered_sink<Ar>, Encoding>{
+		typedef serializer<buffered_sink<Ar>, Encoding> base;
+
+		buffered_serializer(Ar& ar, std::size_t buffer_size) : base(m_sink), m_sink(ar, buffer_size){}
+		buffered_serializer(buffered_serializer&& rhs) : base(m_sink), m_sink(std::move(rhs.m_sink)){}
+
+		/// write the pending data to the underlying archive
+		void flush(){ m_sink.flush();}
+
+		private:
+		buffered_sink<Ar> m_sink;
+	};
+	/// deserializer with a read-ahead buffer, see buffered_source.
+	template<typename Ar, typename Encoding = fixed_encoding> struct buffered_deserializer : public deserializer<buffered_source<Ar>, Encoding>{
+		typedef deserializer<buffered_source<Ar>, Encoding> base;
+
+		buffered_deserializer(Ar& ar, std::size_t buffer_size) : base(m_source), m_source(ar, buffer_size){}
+		buffered_deserializer(buffered_deserializer&& rhs) : base(m_source), m_source(std::move(rhs.m_source)){}
+
+		private:
+		buffered_source<Ar> m_source;
+	};
+	template<typename Ar> buffered_serializer<Ar> as_buffered_sink(Ar& ar, std::size_t buffer_size = default_stage_size){
+		return buffered_serializer<Ar>(ar, buffer_size);
+	}
+	template<typename Ar> buffered_deserializer<Ar> as_buffered_source(Ar& ar, std::size_t buffer_size = default_stage_size){
+		return buffered_deserializer<Ar>(ar, buffer_size);
+	}
+	template<typename Ar, typename Encoding> buffered_serializer<Ar, Encoding> as_buffered_sink(Ar& ar, std::size_t buffer_size, Encoding){
+		return buffered_serializer<Ar, Encoding>(ar, buffer_size);
+	}
+	template<typename Ar, typename Encoding> buffered_deserializer<Ar, Encoding> as_buffered_source(Ar& ar, std::size_t buffer_size, Encoding){
+		return buffered_deserializer<Ar, Encoding>(ar, buffer_size);
+	}
 
 	//TODO: map T to a exchangable type U
 	template<typename T> struct exchange_type_of{ typedef T type;};
@@ -57,6 +342,12 @@ namespace xirang{ namespace io{ namespace exchange{
 			return t;
 		}
 	};
+	/// bool is exchanged as int8_t, see exchange_type_of<bool>
+	template<> struct exchange_cast_imp<bool, std::int8_t>{
+		static std::int8_t apply(bool t){
+			return t ? 1 : 0;
+		}
+	};
 
 	template<typename U, typename T> U exchange_cast(T t){
 		return exchange_cast_imp<T, U>::apply(t);
@@ -67,13 +358,29 @@ namespace xirang{ namespace io{ namespace exchange{
 		}
 	};
 
+	namespace private_{
+		template<typename T> struct void_of_{ typedef void type;};
+	}
+	/// encoding of the serializer, fixed_encoding if Ar doesn't define encoding_type
+	template<typename Ar, typename = void> struct encoding_of{ typedef fixed_encoding type;};
+	template<typename Ar> struct encoding_of<Ar, typename private_::void_of_<typename Ar::encoding_type>::type>{
+		typedef typename Ar::encoding_type type;
+	};
+
+	/// true if T is saved as a varint by Ar
+	template<typename Ar, typename T> struct is_varint_encoded : public std::integral_constant<bool,
+		std::is_same<typename encoding_of<Ar>::type, varint_encoding>::value
+			&& std::is_integral<T>::value && !std::is_same<T, bool>::value
+			&& (sizeof(typename exchange_type_of<T>::type) > 1)>
+	{};
+
 	template<typename Ar, typename T,
 		typename = typename std::enable_if<std::is_scalar<T>::value &&
-			s11n::is_serializer<Ar>::value>::type>
+			s11n::is_serializer<Ar>::value && !is_varint_encoded<Ar, T>::value>::type>
 		Ar& save(Ar& wt, const T& v)
 		{
 			typedef typename exchange_type_of<T>::type U;
-			U t = exchange_cast<U>(v);
+			U t = local2ex_f(exchange_cast<U>(v));
 
 			const byte* first = reinterpret_cast<const byte*>(&t);
 			const byte* last = reinterpret_cast<const byte*>(&t + 1);
@@ -85,7 +392,7 @@ namespace xirang{ namespace io{ namespace exchange{
 
 	template<typename T, typename Ar,
 		typename = typename std::enable_if<std::is_scalar<T>::value &&
-			s11n::is_deserializer<Ar>::value>::type>
+			s11n::is_deserializer<Ar>::value && !is_varint_encoded<Ar, T>::value>::type>
 		Ar& load(Ar& rd, T& v)
 		{
 			typedef typename exchange_type_of<T>::type U;
@@ -101,6 +408,149 @@ namespace xirang{ namespace io{ namespace exchange{
 			return rd;
 		}
 
+	namespace private_{
+		template<typename U> uint64_t to_varint_(U u, std::true_type /* signed */){ return varint::zigzag_encode(u);}
+		template<typename U> uint64_t to_varint_(U u, std::false_type /* signed */){ return u;}
+		template<typename U> U from_varint_(uint64_t v, std::true_type /* signed */){ return exchange_cast<U>(varint::zigzag_decode(v));}
+		template<typename U> U from_varint_(uint64_t v, std::false_type /* signed */){ return exchange_cast<U>(v);}
+
+		/// read byte by byte, the underlying archive is not read beyond the varint
+		template<typename Src> uint64_t read_varint_(Src& src){
+			byte buf[varint::max_size] = {};
+			for (std::size_t i = 0; i < varint::max_size; ++i){
+				if (!io::block_read(src, make_range(buf + i, buf + i + 1)).empty())
+					AIO_THROW(io::read_exception)("truncated varint");
+				if ((uint64_t(buf[i]) & 0x80) == 0)
+					break;
+			}
+			uint64_t v = 0;
+			if (!varint::decode(buf, buf + varint::max_size, v))
+				AIO_THROW(io::read_exception)("bad varint");
+			return v;
+		}
+		/// decode in place
+		inline uint64_t read_varint_(memory_source& src){
+			auto data = src.rest();
+			uint64_t v = 0;
+			auto last = varint::decode(data.begin(), data.end(), v);
+			if (!last)
+				AIO_THROW(io::read_exception)("bad or truncated varint");
+			src.take(last - data.begin());
+			return v;
+		}
+		/// decode in the read-ahead buffer
+		template<typename Ar> uint64_t read_varint_(buffered_source<Ar>& src){
+			auto data = src.fill(varint::max_size);
+			uint64_t v = 0;
+			auto last = varint::decode(data.begin(), data.end(), v);
+			if (!last)
+				AIO_THROW(io::read_exception)("bad or truncated varint");
+			src.consume(last - data.begin());
+			return v;
+		}
+	}
+
+	template<typename Ar, typename T,
+		typename = typename std::enable_if<s11n::is_serializer<Ar>::value && is_varint_encoded<Ar, T>::value>::type,
+		typename = void>
+		Ar& save(Ar& wt, const T& v)
+		{
+			typedef typename exchange_type_of<T>::type U;
+			byte buf[varint::max_size];
+			byte* last = varint::encode(private_::to_varint_(exchange_cast<U>(v), std::is_signed<U>()), buf);
+			io::block_write(get_interface<io::writer>(wt.get()), make_range(static_cast<const byte*>(buf), static_cast<const byte*>(last)));
+			return wt;
+		}
+
+	template<typename T, typename Ar,
+		typename = typename std::enable_if<s11n::is_deserializer<Ar>::value && is_varint_encoded<Ar, T>::value>::type,
+		typename = void>
+		Ar& load(Ar& rd, T& v)
+		{
+			typedef typename exchange_type_of<T>::type U;
+			auto& src = get_interface<io::reader>(rd.get());
+			v = exchange_cast<T>(private_::from_varint_<U>(private_::read_varint_(src), std::is_signed<U>()));
+			return rd;
+		}
+
+	/// true if T is exchanged as is, so a contiguous range of T can be saved or loaded as a whole block
+	/// without per element range check.
+	template<typename T> struct is_bulk_exchangeable : public std::integral_constant<bool,
+		std::is_arithmetic<T>::value && !std::is_same<T, bool>::value
+			&& sizeof(typename exchange_type_of<T>::type) == sizeof(T)
+			&& std::is_signed<T>::value == std::is_signed<typename exchange_type_of<T>::type>::value
+			&& std::is_floating_point<T>::value == std::is_floating_point<typename exchange_type_of<T>::type>::value>
+	{};
+
+	namespace private_{
+		/// elements converted per block if the local byte order is not the exchange one
+		const std::size_t K_SwapBlockSize = 4096;
+
+		template<typename Ar, typename T>
+		void save_range_(Ar& wt, const range<const T*>& r, std::true_type /* bulk */, std::true_type /* same byte order */){
+			const byte* first = reinterpret_cast<const byte*>(r.begin());
+			const byte* last = reinterpret_cast<const byte*>(r.end());
+			io::block_write(get_interface<io::writer>(wt.get()), make_range(first, last));
+		}
+		template<typename Ar, typename T>
+		void save_range_(Ar& wt, const range<const T*>& r, std::true_type /* bulk */, std::false_type /* same byte order */){
+			T block[K_SwapBlockSize / sizeof(T)];
+			for (auto pos = r.begin(); pos != r.end();){
+				auto n = std::min<std::size_t>(r.end() - pos, sizeof(block) / sizeof(T));
+				T* last = byteorder::convert_range<local_endian_tag, exchange_endian_tag>(pos, pos + n, block);
+				io::block_write(get_interface<io::writer>(wt.get()),
+						make_range(reinterpret_cast<const byte*>(block), reinterpret_cast<const byte*>(last)));
+				pos += n;
+			}
+		}
+		template<typename Ar, typename T, typename SameOrder>
+		void save_range_(Ar& wt, const range<const T*>& r, std::false_type /* bulk */, SameOrder){
+			for (auto& i : r)
+				wt & i;
+		}
+
+		template<typename Ar, typename T>
+		void load_range_(Ar& rd, const range<T*>& r, std::true_type /* bulk */, std::true_type /* same byte order */){
+			byte* first = reinterpret_cast<byte*>(r.begin());
+			byte* last = reinterpret_cast<byte*>(r.end());
+			if (!io::block_read(get_interface<io::reader>(rd.get()), make_range(first, last)).empty() )
+				AIO_THROW(io::read_exception);
+		}
+		template<typename Ar, typename T>
+		void load_range_(Ar& rd, const range<T*>& r, std::true_type /* bulk */, std::false_type /* same byte order */){
+			load_range_(rd, r, std::true_type(), std::true_type());
+			byteorder::convert_range<exchange_endian_tag, local_endian_tag>(r.begin(), r.end(), r.begin());
+		}
+		template<typename Ar, typename T, typename SameOrder>
+		void load_range_(Ar& rd, const range<T*>& r, std::false_type /* bulk */, SameOrder){
+			for (auto& i : r)
+				rd & i;
+		}
+	}
+
+	/// save a contiguous range of objects, same bytes as saving them one by one.
+	/// the range is written as a whole block if T is bulk exchangeable.
+	template<typename Ar, typename T,
+		typename = typename std::enable_if<s11n::is_serializer<Ar>::value>::type>
+		Ar& save_range(Ar& wt, const range<const T*>& r)
+		{
+			private_::save_range_(wt, r, std::integral_constant<bool,
+						is_bulk_exchangeable<T>::value && !is_varint_encoded<Ar, T>::value>(),
+					std::is_same<local_endian_tag, exchange_endian_tag>());
+			return wt;
+		}
+
+	/// load a contiguous range of objects saved by save_range or one by one.
+	template<typename Ar, typename T,
+		typename = typename std::enable_if<s11n::is_deserializer<Ar>::value>::type>
+		Ar& load_range(Ar& rd, const range<T*>& r)
+		{
+			private_::load_range_(rd, r, std::integral_constant<bool,
+						is_bulk_exchangeable<T>::value && !is_varint_encoded<Ar, T>::value>(),
+					std::is_same<local_endian_tag, exchange_endian_tag>());
+			return rd;
+		}
+
 }}}
 
 #endif //end AIO_COMMON_IO_S11N_EXCHANGE_H_
@@ -8,14 +8,22 @@
 namespace xirang{ namespace io{
 	struct file_imp;
 
-	struct file_reader // <reader, random >
+	struct file_reader // <reader, random, read_map, options, positional_reader, vector_reader, native_handle, async_reader >
 	{
 		typedef reader::iterator iterator;
 
-		explicit file_reader(const file_path& path);
+		/// \param of only the option bits (above of_low_mask) are used, the file is always opened by of_open
+		explicit file_reader(const file_path& path, int of = of_open);
 		~file_reader();
+		file_reader(file_reader&& rhs);
+		file_reader(const file_reader&) = delete;
+		file_reader& operator=(const file_reader&) = delete;
 
 		range<iterator> read(const range<iterator>& buf);
+		/// lock free, see positional_reader
+		range<iterator> read_at(long_size_t off, const range<iterator>& buf) const;
+		/// preadv if supported by the backend
+		long_size_t readv(const range<const range<iterator>*>& bufs);
 		bool readable() const;
 
 		long_size_t offset() const;
@@ -23,23 +31,38 @@ namespace xirang{ namespace io{
 		long_size_t seek(long_size_t offset);
 
 		unique_ptr<read_view> view_rd(ext_heap::handle h) const;
+
+		/// see async_reader, served by io_uring or worker threads, synchronous on Windows
+		async_result async_read(long_size_t off, const range<iterator>& buf);
+		/// see native_handle
+		native_handle_t handle();
+		void handle_written(long_size_t first, long_size_t last);
+
+		any getopt(int id, const any & optdata = any() ) const;
+		any setopt(int id, const any & optdata,  const any & indata= any());
     private:
 		file_imp * m_imp;;
 	};
 
 	AIO_EXCEPTION_TYPE(archive_append_failed);
 
-	struct file_writer // <writer, random >
+	struct file_writer // <writer, random, write_map, options, vector_writer, native_handle, async_writer >
 	{
 		typedef writer::const_iterator const_iterator;
 		typedef writer::const_iterator iterator;
 
 		explicit file_writer(const file_path& path,  int of);
 		~file_writer();
+		file_writer(file_writer&& rhs);
+		file_writer(const file_writer&) = delete;
+		file_writer& operator=(const file_writer&) = delete;
 
 		range<const_iterator> write(const range<const_iterator>& r);
+		/// pwritev if supported by the backend
+		long_size_t writev(const range<const range<const_iterator>*>& bufs);
 		long_size_t truncate(long_size_t size);
 		bool writable() const;
+		/// throw if failed, the destructor syncs too but ignores the errors.
 		void sync() ;
 
 		long_size_t offset() const;
@@ -47,24 +70,43 @@ namespace xirang{ namespace io{
 		long_size_t seek(long_size_t offset);
 
 		unique_ptr<write_view> view_wr(ext_heap::handle h);
+
+		/// see async_writer, served by io_uring or worker threads, synchronous on Windows
+		async_result async_write(long_size_t off, const range<const_iterator>& buf);
+		/// see native_handle
+		native_handle_t handle();
+		void handle_written(long_size_t first, long_size_t last);
+
+		any getopt(int id, const any & optdata = any() ) const;
+		any setopt(int id, const any & optdata,  const any & indata= any());
     private:
 		file_imp * m_imp;;
 	};
 
-	struct file // <reader, writer, random >
+	struct file // <reader, writer, random, read_map, write_map, options, positional_reader, vector_reader, vector_writer, native_handle, async_reader, async_writer >
 	{
 		typedef reader::iterator iterator;
 		typedef writer::const_iterator const_iterator;
 
 		explicit file(const file_path& path, int of);
 		~file();
+		file(file&& rhs);
+		file(const file&) = delete;
+		file& operator=(const file&) = delete;
 
 		range<iterator> read(const range<iterator>& buf);
+		/// lock free, see positional_reader
+		range<iterator> read_at(long_size_t off, const range<iterator>& buf) const;
+		/// preadv if supported by the backend
+		long_size_t readv(const range<const range<iterator>*>& bufs);
 		bool readable() const;
 
 		range<const_iterator> write(const range<const_iterator>& r);
+		/// pwritev if supported by the backend
+		long_size_t writev(const range<const range<const_iterator>*>& bufs);
 		long_size_t truncate(long_size_t size);
 		bool writable() const;
+		/// throw if failed, the destructor syncs too but ignores the errors.
 		void sync() ;
 
 		long_size_t offset() const;
@@ -73,6 +115,17 @@ namespace xirang{ namespace io{
 
 		unique_ptr<read_view> view_rd(ext_heap::handle h) const;
 		unique_ptr<write_view> view_wr(ext_heap::handle h);
+
+		/// see async_reader, served by io_uring or worker threads, synchronous on Windows
+		async_result async_read(long_size_t off, const range<iterator>& buf);
+		/// see async_writer, served by io_uring or worker threads, synchronous on Windows
+		async_result async_write(long_size_t off, const range<const_iterator>& buf);
+		/// see native_handle
+		native_handle_t handle();
+		void handle_written(long_size_t first, long_size_t last);
+
+		any getopt(int id, const any & optdata = any() ) const;
+		any setopt(int id, const any & optdata,  const any & indata= any());
 	private:
 		file_imp * m_imp;;
 	};
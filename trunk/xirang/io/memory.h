@@ -32,6 +32,8 @@ namespace xirang{ namespace io{
 		explicit buffer_in(const range<const byte*>& buf);
 
 		range<byte*> read(const range<byte*>& buf);
+		range<byte*> read_at(long_size_t off, const range<byte*>& buf) const;
+		long_size_t readv(const range<const range<byte*>*>& bufs);
 		bool readable() const;
 
 		long_size_t offset() const;
@@ -40,6 +42,10 @@ namespace xirang{ namespace io{
 
 		buffer_rd_view view_rd(ext_heap::handle h) const;
 
+		/// no option is supported, hints like ao_access_hint are ignored
+		any getopt(int id, const any & optdata = any() ) const;
+		any setopt(int id, const any & optdata,  const any & indata= any());
+
 		range<const byte*> data() const;
 	private:
 		long_size_t m_pos;
@@ -53,6 +59,7 @@ namespace xirang{ namespace io{
 		explicit buffer_out(buffer<byte>& buf);
 
 		range<const byte*> write(const range<const byte*>& r);
+		long_size_t writev(const range<const range<const byte*>*>& bufs);
 		long_size_t truncate(long_size_t size);
 		bool writable() const;
 		void sync() ;
@@ -76,9 +83,12 @@ namespace xirang{ namespace io{
 
 		explicit buffer_io(buffer<byte>& buf);
 		range<iterator> read(const range<byte*>& buf);
+		range<iterator> read_at(long_size_t off, const range<byte*>& buf) const;
+		long_size_t readv(const range<const range<byte*>*>& bufs);
 		bool readable() const;
 
 		range<const byte*> write(const range<const byte*>& r);
+		long_size_t writev(const range<const range<const byte*>*>& bufs);
 		long_size_t truncate(long_size_t size);
 		bool writable() const;
 		void sync() ;
@@ -90,6 +100,10 @@ namespace xirang{ namespace io{
 		buffer_rd_view view_rd(ext_heap::handle h) const;
 		buffer_wr_view view_wr(ext_heap::handle h);
 
+		/// no option is supported, hints like ao_access_hint are ignored
+		any getopt(int id, const any & optdata = any() ) const;
+		any setopt(int id, const any & optdata,  const any & indata= any());
+
 		buffer<byte> & data();
 		const buffer<byte> & data() const;
 		private:
@@ -104,9 +118,12 @@ namespace xirang{ namespace io{
 		explicit fixed_buffer_io(const range<byte*>& buf);
 
 		range<byte*> read(const range<byte*>& buf);
+		range<byte*> read_at(long_size_t off, const range<byte*>& buf) const;
+		long_size_t readv(const range<const range<byte*>*>& bufs);
 		bool readable() const;
 
 		range<const byte*> write(const range<const byte*>& r);
+		long_size_t writev(const range<const range<const byte*>*>& bufs);
 		bool writable() const;
 		void sync();
 
@@ -154,6 +171,7 @@ namespace xirang{ namespace io{
 	struct null{
 		null();
 		range<const byte*> write(const range<const byte*>& r);
+		long_size_t writev(const range<const range<const byte*>*>& bufs);
 		bool writable() const;
 		void sync() ;
 
@@ -0,0 +1,56 @@
+#ifndef XIRANG_IO_PARALLEL_COPY_H
+#define XIRANG_IO_PARALLEL_COPY_H
+
+#include <xirang/io.h>
+#include <xirang/sha1.h>
+
+// STD
+#include <algorithm>
+#include <vector>
+#include <thread>
+
+namespace xirang{ namespace io{
+
+	enum checksum_kind
+	{
+		ck_none,
+		ck_crc32,
+		ck_sha1
+	};
+
+	struct parallel_copy_options
+	{
+		parallel_copy_options()
+			: threads(std::max(1u, std::thread::hardware_concurrency())), chunk_size(8 * 1024 * 1024)
+			, min_size(32 * 1024 * 1024), checksum(ck_none){}
+
+		std::size_t threads;		///< count of worker threads, hardware concurrency by default, 1 copies in current thread
+		long_size_t chunk_size;		///< bytes copied by a task, rounded up to the allocation granularity, 64KB
+		long_size_t min_size;		///< smaller copies are done in current thread
+		checksum_kind checksum;		///< checksum computed while copying each chunk
+	};
+
+	/// checksum of the chunk [first, last) of the copied data
+	struct chunk_checksum
+	{
+		chunk_checksum() : first(0), last(0), crc32(0){}
+
+		long_size_t first;
+		long_size_t last;
+		uint32_t crc32;		///< valid if ck_crc32
+		sha1_digest sha1;	///< valid if ck_sha1
+	};
+
+	/// same as copy_data(rd, wr, max_size), but the range is split into chunks copied by worker threads.
+	/// wr is truncated to the copied size first if it's smaller, so views don't extend it one by one.
+	/// views are created and destroyed in current thread, only the memory copy runs in workers,
+	/// so rd and wr need not be thread safe.
+	/// \note workers are spawned and joined per call, it only pays off for large copies on multi-core machines,
+	/// so it's not used implicitly by copy_data or the vfs, callers opt in.
+	/// \param checksums if not null, filled with the checksum of each chunk in order.
+	/// \return the real copied bytes
+	extern long_size_t copy_data_parallel(read_map& rd, write_map& wr, long_size_t max_size = ~0,
+			const parallel_copy_options& opts = parallel_copy_options(), std::vector<chunk_checksum>* checksums = 0);
+}}
+
+#endif //end XIRANG_IO_PARALLEL_COPY_H
@@ -0,0 +1,143 @@
+#ifndef XIRANG_IO_S11N_FIELDS_H
+#define XIRANG_IO_S11N_FIELDS_H
+#include <xirang/io/exchs11n.h>
+
+// STD
+#include <cstddef>
+
+/// XIRANG_S11N_FIELDS(Type, fields...) defines load and save of Type, the fields are serialized in order.
+/// it must be placed in the namespace of Type, so load and save are found by ADL.
+/// if the fields are fixed size exchange types or such structs, and they are placed in order without padding,
+/// the whole object is saved or loaded by one block copy on the hosts of exchange byte order.
+#define XIRANG_S11N_FIELDS(Type, ...) \
+	template<typename Ar, typename = \
+		typename std::enable_if< ::xirang::io::s11n::is_deserializer<Ar>::value>::type> \
+	Ar& load(Ar& ar, Type& v){ \
+		return ::xirang::io::s11n::load_fields(ar, v, XIRANG_S11N_EACH_(XIRANG_S11N_MEMBER_, v, __VA_ARGS__)); \
+	} \
+	template<typename Ar, typename = \
+		typename std::enable_if< ::xirang::io::s11n::is_serializer<Ar>::value>::type> \
+	Ar& save(Ar& ar, const Type& v){ \
+		return ::xirang::io::s11n::save_fields(ar, v, XIRANG_S11N_EACH_(XIRANG_S11N_MEMBER_, v, __VA_ARGS__)); \
+	} \
+	::xirang::io::s11n::fields_layout< \
+		::xirang::io::s11n::private_::is_contiguous_(sizeof(Type), 0, XIRANG_S11N_EACH_(XIRANG_S11N_LAYOUT_, Type, __VA_ARGS__)) \
+		&& ::xirang::io::s11n::private_::all_fixed_<XIRANG_S11N_EACH_(XIRANG_S11N_TYPE_, Type, __VA_ARGS__)>::value> \
+	s11n_fields_layout_(const Type*)
+
+#define XIRANG_S11N_MEMBER_(v, f) v.f
+#define XIRANG_S11N_LAYOUT_(Type, f) offsetof(Type, f), sizeof(Type::f)
+#define XIRANG_S11N_TYPE_(Type, f) decltype(Type::f)
+
+#define XIRANG_S11N_CAT_(a, b) XIRANG_S11N_CAT_I_(a, b)
+#define XIRANG_S11N_CAT_I_(a, b) a##b
+/// m(d, x) for each x, separated by comma. up to 16 items.
+#define XIRANG_S11N_EACH_(m, d, ...) XIRANG_S11N_CAT_(XIRANG_S11N_EACH_, XIRANG_S11N_NARG_(__VA_ARGS__))(m, d, __VA_ARGS__)
+#define XIRANG_S11N_NARG_(...) XIRANG_S11N_NARG_I_(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1)
+#define XIRANG_S11N_NARG_I_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, N, ...) N
+#define XIRANG_S11N_EACH_1(m, d, x) m(d, x)
+#define XIRANG_S11N_EACH_2(m, d, x, ...) m(d, x), XIRANG_S11N_EACH_1(m, d, __VA_ARGS__)
+#define XIRANG_S11N_EACH_3(m, d, x, ...) m(d, x), XIRANG_S11N_EACH_2(m, d, __VA_ARGS__)
+#define XIRANG_S11N_EACH_4(m, d, x, ...) m(d, x), XIRANG_S11N_EACH_3(m, d, __VA_ARGS__)
+#define XIRANG_S11N_EACH_5(m, d, x, ...) m(d, x), XIRANG_S11N_EACH_4(m, d, __VA_ARGS__)
+#define XIRANG_S11N_EACH_6(m, d, x, ...) m(d, x), XIRANG_S11N_EACH_5(m, d, __VA_ARGS__)
+#define XIRANG_S11N_EACH_7(m, d, x, ...) m(d, x), XIRANG_S11N_EACH_6(m, d, __VA_ARGS__)
+#define XIRANG_S11N_EACH_8(m, d, x, ...) m(d, x), XIRANG_S11N_EACH_7(m, d, __VA_ARGS__)
+#define XIRANG_S11N_EACH_9(m, d, x, ...) m(d, x), XIRANG_S11N_EACH_8(m, d, __VA_ARGS__)
+#define XIRANG_S11N_EACH_10(m, d, x, ...) m(d, x), XIRANG_S11N_EACH_9(m, d, __VA_ARGS__)
+#define XIRANG_S11N_EACH_11(m, d, x, ...) m(d, x), XIRANG_S11N_EACH_10(m, d, __VA_ARGS__)
+#define XIRANG_S11N_EACH_12(m, d, x, ...) m(d, x), XIRANG_S11N_EACH_11(m, d, __VA_ARGS__)
+#define XIRANG_S11N_EACH_13(m, d, x, ...) m(d, x), XIRANG_S11N_EACH_12(m, d, __VA_ARGS__)
+#define XIRANG_S11N_EACH_14(m, d, x, ...) m(d, x), XIRANG_S11N_EACH_13(m, d, __VA_ARGS__)
+#define XIRANG_S11N_EACH_15(m, d, x, ...) m(d, x), XIRANG_S11N_EACH_14(m, d, __VA_ARGS__)
+#define XIRANG_S11N_EACH_16(m, d, x, ...) m(d, x), XIRANG_S11N_EACH_15(m, d, __VA_ARGS__)
+
+namespace xirang{ namespace io{ namespace s11n{
+
+	/// result type of s11n_fields_layout_, Fixed is true if the fields are the exchange layout of the type
+	template<bool Fixed> struct fields_layout : public std::integral_constant<bool, Fixed>{};
+
+	/// fallback of types not defined by XIRANG_S11N_FIELDS, declaration only
+	fields_layout<false> s11n_fields_layout_(const void*);
+
+	/// true if T has fixed size in exchange format, and its memory is the same as the exchange format
+	/// on the hosts of exchange byte order.
+	template<typename T> struct is_fixed_field : public std::integral_constant<bool,
+		exchange::is_bulk_exchangeable<T>::value
+			|| (std::is_enum<T>::value && std::is_same<typename exchange::exchange_type_of<T>::type, T>::value)
+			|| (decltype(s11n_fields_layout_((const T*)0))::value && std::is_trivially_copyable<T>::value)>
+	{};
+	template<typename T, std::size_t N> struct is_fixed_field<T[N]> : public is_fixed_field<T>{};
+
+	namespace private_{
+		constexpr bool is_contiguous_(std::size_t total, std::size_t pos){
+			return pos == total;
+		}
+		/// the fields are in order and without padding
+		template<typename... T>
+		constexpr bool is_contiguous_(std::size_t total, std::size_t pos, std::size_t offset, std::size_t size, T... rest){
+			return offset == pos && is_contiguous_(total, pos + size, rest...);
+		}
+
+		template<typename... T> struct all_fixed_;
+		template<> struct all_fixed_<> : public std::true_type{};
+		template<typename T, typename... Rest> struct all_fixed_<T, Rest...> : public std::integral_constant<bool,
+			is_fixed_field<T>::value && all_fixed_<Rest...>::value>
+		{};
+
+		/// T is saved by one block copy
+		template<typename Ar, typename T> struct use_block_copy_ : public std::integral_constant<bool,
+			is_fixed_field<T>::value
+				&& std::is_same<local_endian_tag, exchange_endian_tag>::value
+				&& std::is_same<typename exchange::encoding_of<Ar>::type, exchange::fixed_encoding>::value>
+		{};
+
+		template<typename Ar, typename T> void save_field_(Ar& ar, const T& t){ ar & t; }
+		template<typename Ar, typename T, std::size_t N> void save_field_(Ar& ar, const T (&t)[N]){
+			for (auto& i : t)
+				save_field_(ar, i);
+		}
+		template<typename Ar, typename T> void load_field_(Ar& ar, T& t){ ar & t; }
+		template<typename Ar, typename T, std::size_t N> void load_field_(Ar& ar, T (&t)[N]){
+			for (auto& i : t)
+				load_field_(ar, i);
+		}
+
+		template<typename Ar, typename T, typename... Fields>
+		void save_fields_(Ar& ar, const T& v, std::true_type /* block copy */, const Fields&...){
+			const byte* first = reinterpret_cast<const byte*>(&v);
+			io::block_write(get_interface<io::writer>(ar.get()), make_range(first, first + sizeof(T)));
+		}
+		template<typename Ar, typename T, typename... Fields>
+		void save_fields_(Ar& ar, const T& , std::false_type /* block copy */, const Fields&... fields){
+			int order[] = { 0, (save_field_(ar, fields), 0)... };
+			unuse(order);
+		}
+		template<typename Ar, typename T, typename... Fields>
+		void load_fields_(Ar& ar, T& v, std::true_type /* block copy */, Fields&...){
+			byte* first = reinterpret_cast<byte*>(&v);
+			if (!io::block_read(get_interface<io::reader>(ar.get()), make_range(first, first + sizeof(T))).empty())
+				AIO_THROW(io::read_exception);
+		}
+		template<typename Ar, typename T, typename... Fields>
+		void load_fields_(Ar& ar, T& , std::false_type /* block copy */, Fields&... fields){
+			int order[] = { 0, (load_field_(ar, fields), 0)... };
+			unuse(order);
+		}
+	}
+
+	/// save fields of v in order, or v as a whole if its layout is fixed
+	template<typename Ar, typename T, typename... Fields>
+	Ar& save_fields(Ar& ar, const T& v, const Fields&... fields){
+		private_::save_fields_(ar, v, private_::use_block_copy_<Ar, T>(), fields...);
+		return ar;
+	}
+	/// load fields of v in order, or v as a whole if its layout is fixed
+	template<typename Ar, typename T, typename... Fields>
+	Ar& load_fields(Ar& ar, T& v, Fields&... fields){
+		private_::load_fields_(ar, v, private_::use_block_copy_<Ar, T>(), fields...);
+		return ar;
+	}
+}}}
+
+#endif //end XIRANG_IO_S11N_FIELDS_H
@@ -1,25 +1,9 @@
 #ifndef XIRANG_IO_SHA1_DIGEST_H
 #define XIRANG_IO_SHA1_DIGEST_H
 #include <xirang/io/s11n.h>
+#include <xirang/io/s11nfields.h>
 #include <xirang/sha1.h>
 namespace xirang{
-	template<typename Ar, typename =
-		typename std::enable_if<io::s11n::is_deserializer<Ar>::value>::type>
-	Ar& load (Ar& ar, sha1_digest& dig)
-	{
-		for (auto& i : dig.v)
-			ar & i;
-		return ar;
-	}
-	template<typename Ar, typename =
-		typename std::enable_if< io::s11n::is_serializer<Ar>::value>::type>
-	Ar& save(Ar& ar, const sha1_digest& dig)
-	{
-		for (auto i : dig.v)
-			ar & i;
-		return ar;
-	}
-
-
+	XIRANG_S11N_FIELDS(sha1_digest, v);
 }
 #endif //XIRANG_IO_SHA1_DIGEST_H
@@ -83,6 +83,17 @@ namespace xirang{namespace io{ namespace exchange{
 		return ar;
 	}
 
+	/// load a string saved as basic_string<char> without copy, str points into the memory of the source
+	template<typename Ar, typename =
+		typename std::enable_if< is_memory_deserializer<Ar>::value>::type>
+	Ar& load(Ar& ar, const_range_string& str)
+	{
+		size_t size = exchange_cast<size_t>(load<uint32_t>(ar));
+		auto data = ar.get().take(size);
+		str = const_range_string(reinterpret_cast<const char*>(data.begin()), reinterpret_cast<const char*>(data.end()));
+		return ar;
+	}
+
 	template<typename Ar, typename =
 		typename std::enable_if< s11n::is_serializer<Ar>::value>::type>
 	Ar& save(Ar& ar, const basic_string<char>& str)
@@ -104,12 +115,9 @@ namespace xirang{namespace io{ namespace exchange{
 		size_t size = exchange_cast<size_t>(load<uint32_t>(ar));
 		if (size > 0)
 		{
-			typedef typename exchange_type_of<T>::type U;
 			buffer<T> rbuf;
-			rbuf.reserve(size);
-			for (auto i = size; i > 0; --i){
-				rbuf.push_back(exchange_cast<T>(load<U>(ar)));
-			}
+			rbuf.resize(size);
+			load_range(ar, make_range(rbuf.begin(), rbuf.end()));
 			str = make_range(rbuf.begin(), rbuf.end());
 		}
 		else
@@ -125,11 +133,7 @@ namespace xirang{namespace io{ namespace exchange{
 		uint32_t size = exchange_cast<uint32_t>(str.size());
 		save(ar, size);
 		if (!str.empty())
-		{
-			typedef typename exchange_type_of<T>::type U;
-			for (auto i : str)
-				ar & exchange_cast<U>(i);
-		}
+			save_range(ar, make_range(str.data(), str.data() + str.size()));
 		return ar;
 	}
 
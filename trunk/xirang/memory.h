@@ -126,11 +126,20 @@ namespace xirang
 		/// return the global heap.
 		AIO_COMM_API extern heap& get_global_heap();
 
+		/// return the heap of the innermost thread_heap_scope in current thread, or the global heap if there is none.
+		/// it's the default heap of abi_allocator, string and buffer.
+		AIO_COMM_API extern heap& get_current_heap();
+
         AIO_COMM_API extern ext_heap& get_global_ext_heap();
 
 		/// set the global heap.
 		AIO_COMM_API extern void set_global_heap(heap& newHeap);
 
+		/// return the process wide thread caching heap, a multi_thread pool_heap over the platform heap.
+		/// it's never destroyed, so it can be passed to set_global_heap at any time.
+		/// it's the default global heap if AIO_THREAD_CACHING_GLOBAL_HEAP is defined.
+		AIO_COMM_API extern heap& get_thread_caching_heap();
+
 		AIO_COMM_API void init_global_heap_once();
 
 		/// define the thread poliy enumeration
@@ -174,6 +183,23 @@ namespace xirang
 		heap& m_saved;
 	};
 
+	/// helper class, it sets the current heap of current thread and restores the previous one before leaving scope.
+	/// unlike heap_saver, other threads are not affected. scopes can be nested.
+	class AIO_COMM_API thread_heap_scope
+	{
+	public:
+		///\ctor set the current heap of current thread
+		explicit thread_heap_scope(heap& h);
+
+		///\dtor restore the previous heap of current thread
+		~thread_heap_scope();
+
+		thread_heap_scope(const thread_heap_scope&) = delete;
+		thread_heap_scope& operator=(const thread_heap_scope&) = delete;
+	private:
+		heap* m_saved;
+	};
+
 	typedef uint64_t long_size_t;
 	typedef int64_t long_offset_t;
 	struct offset_range {
@@ -285,7 +311,7 @@ namespace xirang
 
 		const_pointer address(const_reference val) const{ return (&val); }
 
-		abi_allocator() : m_handle(&memory::get_global_heap()){}
+		abi_allocator() : m_handle(&memory::get_current_heap()){}
 
 		explicit abi_allocator(heap& h) : m_handle(&h){}
 
@@ -359,7 +385,7 @@ namespace xirang
 			typedef abi_allocator<Other> other;
 		};
 
-		abi_allocator() : m_handle(&memory::get_global_heap()){}
+		abi_allocator() : m_handle(&memory::get_current_heap()){}
 
 		explicit abi_allocator(heap& h) : m_handle(&h){}
 
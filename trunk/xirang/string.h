@@ -448,7 +448,7 @@ namespace xirang
 		}
 
 		heap& get_heap() const {
-			return empty() ? memory::get_global_heap() : *m_data->heap_ptr;
+			return empty() ? memory::get_current_heap() : *m_data->heap_ptr;
 		}
 
 		template<typename T, typename U>
@@ -626,7 +626,7 @@ namespace xirang
 		static const size_type npos = size_type(-1);
 
 		//ctor
-		explicit basic_string_builder(heap& h = memory::get_global_heap())
+		explicit basic_string_builder(heap& h = memory::get_current_heap())
 			: m_heap(&h)
 			, m_capacity(0)
 			, m_size(0)
@@ -661,7 +661,7 @@ namespace xirang
 		}
 
 		basic_string_builder(const basic_range_string<const CharT>& rhs
-				, heap& h = memory::get_global_heap())
+				, heap& h = memory::get_current_heap())
 			: m_heap(&h)
 			, m_capacity(0)
 			, m_size(rhs.size())
@@ -678,7 +678,7 @@ namespace xirang
 		}
 
 		basic_string_builder(const_pointer rhs, size_type pos = 0, size_type n = npos)
-			: m_heap(&memory::get_global_heap())
+			: m_heap(&memory::get_current_heap())
 			, m_capacity(0)
 			, m_size(0)
 			, m_data(0)
@@ -719,7 +719,7 @@ namespace xirang
 			}
 		}
 		basic_string_builder(size_type count, CharT ch
-				, heap& h = memory::get_global_heap())
+				, heap& h = memory::get_current_heap())
 			: m_heap(&h)
 			, m_capacity(0)
 			, m_size(count)
@@ -735,7 +735,7 @@ namespace xirang
 		}
 		template<typename ForwardIterator>
 		basic_string_builder(const range<ForwardIterator>& r
-				, heap& h = memory::get_global_heap())
+				, heap& h = memory::get_current_heap())
 			: m_heap(&h)
 			, m_capacity(0)
 			, m_size(0)
@@ -754,7 +754,7 @@ namespace xirang
 		}
 
 		basic_string_builder(const basic_string<CharT>& rhs
-				, heap& h = memory::get_global_heap())
+				, heap& h = memory::get_current_heap())
 			: m_heap(&h)
 			, m_capacity(0)
 			, m_size(rhs.size())
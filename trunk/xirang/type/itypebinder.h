@@ -64,6 +64,15 @@ namespace xirang {namespace type {
 		/// \pre obj.valid() && obj is allocated but not constructed
 		virtual void deserialize(io::reader& rd, CommonObject obj, heap& inner, ext_heap& outer);
 
+		/// serialize count objects stored contiguously from first, the stride is the payload of the type.
+		/// same as serialize them one by one, primitive types can write them as a whole.
+		/// \pre count == 0 || first.valid()
+		virtual void serializeRange(io::writer& wr, ConstCommonObject first, std::size_t count);
+
+		/// deserialize count objects stored contiguously from first.
+		/// \pre count == 0 || first.valid()
+		virtual void deserializeRange(io::reader& rd, CommonObject first, std::size_t count, heap& inner, ext_heap& outer);
+
 		/// calculate object version
 		///\pre &t.method() == this;
 		virtual version_type getTypeVersion(Type t) const;
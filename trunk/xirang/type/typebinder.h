@@ -123,6 +123,39 @@ namespace xirang { namespace type{
 	template<typename T> deserializer<T> get_deserializer(T*) { return deserializer<T>();}
 	template<typename T> extendMethods<T> get_extendMethods(T*) { return extendMethods<T>();}
 
+	/// serializes contiguous objects one by one
+	template<typename T, typename = void> struct range_serializer{
+		static void apply(io::writer& wr, ConstCommonObject first, std::size_t count){
+			Type t = first.type();
+			const T* p = static_cast<const T*>(first.data());
+			for (std::size_t i = 0; i < count; ++i)
+				get_serializer((T*)0).apply(wr, ConstCommonObject(t, p + i));
+		}
+	};
+	/// arithmetic objects are serialized as a whole
+	template<typename T> struct range_serializer<T, typename std::enable_if<std::is_arithmetic<T>::value>::type>{
+		static void apply(io::writer& wr, ConstCommonObject first, std::size_t count){
+			const T* p = static_cast<const T*>(first.data());
+			auto s = io::exchange::as_sink(wr);
+			io::exchange::save_range(s, make_range(p, p + count));
+		}
+	};
+	template<typename T, typename = void> struct range_deserializer{
+		static void apply(io::reader& rd, CommonObject first, std::size_t count, heap& inner, ext_heap& outer){
+			Type t = first.type();
+			T* p = static_cast<T*>(first.data());
+			for (std::size_t i = 0; i < count; ++i)
+				get_deserializer((T*)0).apply(rd, CommonObject(t, p + i), inner, outer);
+		}
+	};
+	template<typename T> struct range_deserializer<T, typename std::enable_if<std::is_arithmetic<T>::value>::type>{
+		static void apply(io::reader& rd, CommonObject first, std::size_t count, heap& inner, ext_heap& outer){
+			T* p = static_cast<T*>(first.data());
+			auto s = io::exchange::as_source(rd);
+			io::exchange::load_range(s, make_range(p, p + count));
+		}
+	};
+
 	template<typename T>
 		struct PrimitiveMethods : public TypeMethods
 	{
@@ -156,6 +189,14 @@ namespace xirang { namespace type{
 		virtual void deserialize(io::reader& rd, CommonObject obj, heap& inner, ext_heap& outer){
 			get_deserializer((T*)0).apply(rd, obj, inner, outer);
 		}
+		virtual void serializeRange(io::writer& wr, ConstCommonObject first, std::size_t count){
+			if (count > 0)
+				range_serializer<T>::apply(wr, first, count);
+		}
+		virtual void deserializeRange(io::reader& rd, CommonObject first, std::size_t count, heap& inner, ext_heap& outer){
+			if (count > 0)
+				range_deserializer<T>::apply(rd, first, count, inner, outer);
+		}
 
 		virtual version_type getTypeVersion(Type t) const{
 			AIO_PRE_CONDITION(t.valid());
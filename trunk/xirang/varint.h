@@ -0,0 +1,87 @@
+#ifndef XIRANG_VARINT_H
+#define XIRANG_VARINT_H
+
+#include <xirang/buffer.h>
+#include <xirang/endian.h>
+
+// STD
+#include <cstdint>
+#include <cstring>
+
+namespace xirang{
+
+	/// LEB128 variable length integers, 7 bits per byte, the high bit is set in all bytes but the last one.
+	namespace varint{
+
+		/// max bytes of an encoded 64 bits integer
+		const std::size_t max_size = 10;
+
+		/// map signed integers to unsigned ones, so small negative numbers are encoded in a few bytes too
+		inline uint64_t zigzag_encode(int64_t v){
+			return (uint64_t(v) << 1) ^ uint64_t(v >> 63);
+		}
+		inline int64_t zigzag_decode(uint64_t v){
+			return int64_t(v >> 1) ^ -int64_t(v & 1);
+		}
+
+		/// encode v to dest, dest must have max_size bytes at least.
+		/// \return the end of encoded bytes
+		inline byte* encode(uint64_t v, byte* dest){
+			while (v >= 0x80){
+				*dest++ = byte(v | 0x80);
+				v >>= 7;
+			}
+			*dest++ = byte(v);
+			return dest;
+		}
+
+		namespace private_{
+			/// decode byte by byte, at most max_size bytes
+			inline const byte* decode_bytes_(const byte* first, const byte* last, uint64_t& v){
+				uint64_t ret = 0;
+				for (unsigned shift = 0; first != last && shift < 64; shift += 7){
+					uint64_t b = uint64_t(*first++);
+					if (shift == 63 && b > 1)
+						return 0;	// overflow
+					ret |= (b & 0x7f) << shift;
+					if (b < 0x80){
+						v = ret;
+						return first;
+					}
+				}
+				return 0;
+			}
+		}
+
+		/// decode an integer from [first, last)
+		/// \return the end of decoded bytes, or null if [first, last) is truncated or the value overflows
+		inline const byte* decode(const byte* first, const byte* last, uint64_t& v){
+#if defined(AIO_LITTLE_ENDIAN) && defined(__GNUC__)
+			// values up to 8 bytes are decoded without branches per byte:
+			// find the last byte by its clear high bit, then gather the 7-bit groups.
+			if (std::size_t(last - first) >= sizeof(uint64_t)){
+				uint64_t w;
+				std::memcpy(&w, first, sizeof(w));
+				uint64_t stops = ~w & 0x8080808080808080ull;
+				if (stops != 0){
+					unsigned bits = __builtin_ctzll(stops) + 1;	// 8 * encoded bytes
+					if (bits < 64)
+						w &= (uint64_t(1) << bits) - 1;
+					v = (w & 0x7f)
+						| (w >> 1 & 0x7full << 7)
+						| (w >> 2 & 0x7full << 14)
+						| (w >> 3 & 0x7full << 21)
+						| (w >> 4 & 0x7full << 28)
+						| (w >> 5 & 0x7full << 35)
+						| (w >> 6 & 0x7full << 42)
+						| (w >> 7 & 0x7full << 49);
+					return first + bits / 8;
+				}
+			}
+#endif
+			return private_::decode_bytes_(first, last, v);
+		}
+	}
+}
+
+#endif //end XIRANG_VARINT_H
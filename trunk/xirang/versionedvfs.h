@@ -170,6 +170,12 @@ namespace xirang{ namespace vfs{
 	};
 
 
+	/// options of LocalRepository
+	enum repository_option
+	{
+		ro_direct_ingest = vo_user,	///< bool, appended blobs bypass the page cache, see io::of_direct_io
+	};
+
 	class LocalRepositoryImp;
 	class LocalRepository : public IRepository{
 	public:
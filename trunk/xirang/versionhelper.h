@@ -15,8 +15,10 @@ namespace xirang{
 
 	template<typename T> sha1_digest  sha1_of_object(const T& t){
 		sha1 sha;
-		auto ssha = io::exchange::as_sink(sha);
-		ssha & t;
+		{
+			auto ssha = io::exchange::as_buffered_sink(sha);
+			ssha & t;
+		}
 		return sha.get_digest();
 	}
 	template<typename T> version_type version_of_object(const T& t){
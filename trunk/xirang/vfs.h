@@ -45,6 +45,24 @@ namespace xirang { namespace vfs{ namespace detail{
 	template<> struct interface_mask<io::write_map>{
 		static const unsigned long long value = 1 << 10;
 	};
+	template<> struct interface_mask<io::positional_reader>{
+		static const unsigned long long value = 1 << 11;
+	};
+	template<> struct interface_mask<io::vector_reader>{
+		static const unsigned long long value = 1 << 12;
+	};
+	template<> struct interface_mask<io::vector_writer>{
+		static const unsigned long long value = 1 << 13;
+	};
+	template<> struct interface_mask<io::native_handle>{
+		static const unsigned long long value = 1 << 14;
+	};
+	template<> struct interface_mask<io::async_reader>{
+		static const unsigned long long value = 1 << 15;
+	};
+	template<> struct interface_mask<io::async_writer>{
+		static const unsigned long long value = 1 << 16;
+	};
 
 	template<typename I, typename... Interfaces> struct get_mask{
 		static const unsigned long long value = interface_mask<I>::value | get_mask<Interfaces...>::value;
@@ -147,6 +165,7 @@ namespace xirang { namespace vfs{ namespace detail{
         vo_default = 0,
         vo_readonly,
         vo_sync_on_destroy,
+        vo_io_stats,        ///< bool, archives created afterwards are wrapped by io::stats_archive, see io::ao_io_stats
         vo_user = 1 << 16
     };
 
@@ -24,7 +24,7 @@ namespace xirang{ namespace vfs{
 
 		// file operations
 		io::file writeOpen(sub_file_path path, int flag);
-		io::file_reader readOpen(sub_file_path path);
+		io::file_reader readOpen(sub_file_path path, int flag = io::of_open);
 
 		// \pre !absolute(to)
 		// if from and to in same fs, it may have a more effective implementation
@@ -54,6 +54,9 @@ namespace xirang{ namespace vfs{
 		// \pre !absolute(path)
 		virtual VfsState state(sub_file_path path) const;
 
+		virtual any getopt(int id, const any & optdata = any() ) const ;
+		virtual any setopt(int id, const any & optdata,  const any & indata= any());
+
 		virtual void** do_create(unsigned long long mask,
 				void** base, unique_ptr<void>& owner, sub_file_path path, int flag);
 	private:
@@ -62,6 +65,7 @@ namespace xirang{ namespace vfs{
 
 		RootFs* m_root;
 		file_path m_resource;
+		bool m_io_stats;
 
 
 		LocalFs(const LocalFs&); //disable
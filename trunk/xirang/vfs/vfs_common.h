@@ -5,7 +5,8 @@
 namespace xirang{ namespace vfs{
 
     extern fs_error remove_check(IVfs& fs, sub_file_path path);
-	extern fs_error copyFile(const VfsNode& from, const VfsNode& to);
+	/// \param native both from and to support native_handle, copy by kernel if possible.
+	extern fs_error copyFile(const VfsNode& from, const VfsNode& to, bool native = false);
 }}
 #endif //end SRC_XIRANG_VFS_VFS_COMMON_H
 
@@ -83,6 +83,7 @@ namespace xirang{ namespace zip{
 
 			reader_writer();
 			~reader_writer();
+			/// \param ar package archive. open it with io::of_direct_io to keep large appended entries out of page cache.
 			explicit reader_writer(const iref<io::read_map, io::write_map>& ar);
 			reader_writer(reader_writer&& rhs);
 			reader_writer& operator=(reader_writer&& rhs);